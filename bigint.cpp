@@ -2,8 +2,122 @@
 #include <iostream>
 #include <string>
 #include <climits>
+#include <cfloat>
+#include <cmath>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <random>
+#include <cstdlib>
 using namespace std;
 
+/*
+//  Digit storage (see DigitBuffer in bigint.h).
+*/
+DigitBuffer::DigitBuffer(){
+    block = nullptr;
+}
+
+DigitBuffer::DigitBuffer(const DigitBuffer &b){
+    block = b.block;
+    if (block) {
+        block->references.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+DigitBuffer::~DigitBuffer(){
+    release();
+}
+
+/*
+//  Drops this buffer's reference, deleting the block if it was the last.
+*/
+void DigitBuffer::release(){
+    if (block && block->references.fetch_sub(1, memory_order_acq_rel) == 1) {
+        delete block;
+    }
+    block = nullptr;
+}
+
+DigitBuffer & DigitBuffer::operator = (const DigitBuffer &b){
+    if (b.block) {
+        b.block->references.fetch_add(1, memory_order_relaxed);
+    }
+    release();
+    block = b.block;
+    return *this;
+}
+
+DigitBuffer & DigitBuffer::operator = (vector<int> &&digits){
+    overwrite().swap(digits);
+    return *this;
+}
+
+DigitBuffer & DigitBuffer::operator = (const vector<int> &digits){
+    overwrite() = digits;
+    return *this;
+}
+
+/*
+//  Equal digit sequences; buffers sharing a block are equal in O(1).
+*/
+bool DigitBuffer::operator == (const DigitBuffer &b) const{
+    if (block == b.block) {
+        return true;
+    }
+    if (size() != b.size()) {
+        return false;
+    }
+    return size() == 0 || block->digits == b.block->digits;
+}
+
+/*
+//  Slow path of mutate(): gives this buffer a block of its own, copying
+//  the digits if the current block is shared.
+*/
+vector<int> & DigitBuffer::detach(){
+    if (!block) {
+        block = new Block();
+        block->references.store(1, memory_order_relaxed);
+    }
+    else if (block->references.load(memory_order_acquire) != 1) {
+        Block *copy = new Block();
+        copy->references.store(1, memory_order_relaxed);
+        copy->digits = block->digits;
+        release();
+        block = copy;
+    }
+    return block->digits;
+}
+
+/*
+//  Returns the digits for replacing wholesale: a shared block is left to
+//  its other owners and a fresh one started, without copying.
+*/
+vector<int> & DigitBuffer::overwrite(){
+    if (block && block->references.load(memory_order_acquire) != 1) {
+        release();
+    }
+    if (!block) {
+        block = new Block();
+        block->references.store(1, memory_order_relaxed);
+    }
+    return block->digits;
+}
+
+void DigitBuffer::insert(size_t index, int digit){
+    vector<int> &digits = mutate();
+    digits.insert(digits.begin() + index, digit);
+}
+
 /*
 //   Creates a default BigInt with base 10.
 */
@@ -33,37 +147,136 @@ BigInt::BigInt(int setbase){
 //  e.g., (100,16) <--- 100 base 10 to base 16 --> result: BigInt with value 64 base 16
 */
 BigInt::BigInt(int input,int setbase){
+    assignInteger(scalarMagnitude(input), scalarNegative(input), setbase);
+}
+
+/*
+//  Creates a BigInt from a 128 bit integer with a specified base.
+*/
+BigInt::BigInt(__int128 input, int setbase){
+    unsigned __int128 m = input < 0 ? 0 - (unsigned __int128) input : (unsigned __int128) input;
+    assignInteger(m, input < 0, setbase);
+}
+
+BigInt::BigInt(unsigned __int128 input, int setbase){
+    assignInteger(input, false, setbase);
+}
+
+/*
+//  Creates a BigInt from a floating point value with a specified base.
+//    The value is truncated toward zero, like a cast to an integer.
+//    Infinity and NaN give an Invalid Conversion Error and a value of 0.
+*/
+BigInt::BigInt(double input, int setbase){
+    assignFloating(input, setbase);
+}
+
+BigInt::BigInt(long double input, int setbase){
+    assignFloating(input, setbase);
+}
+
+/*
+//  Sets the BigInt to sign * m in the given base, one digit per
+//  division by the base. Zero is stored as a single 0 digit.
+*/
+void BigInt::assignInteger(unsigned __int128 m, bool negative, int setbase){
     if(setbase < 2 || setbase > 36){
         cout << "Invalid Base Error";
         return;
     }
     base = setbase;
-    //deal with negatives
-    if (input < 0) {
-        isPositive = false;
-        input *= -1;
+    isPositive = !negative || m == 0;
+    do {
+        vec.push_back((int) (m % base));
+        m /= base;
+    } while (m != 0);
+}
+
+/*
+//  Sets the BigInt to the truncated value of a finite floating point number.
+//    - |input| = fraction * 2^exponent with 0.5 <= fraction < 1, so
+//      anything below 2^64 is converted directly.
+//    - Above that the significand (at most 64 bits) is read out as an
+//      integer and scaled by a power of two, which is exact.
+*/
+void BigInt::assignFloating(long double input, int setbase){
+    if (!isfinite(input)) {
+        cout << "Invalid Conversion Error";
+        assignInteger(0, false, setbase);
+        return;
     }
-    else {
-        isPositive = true;
+    long double magnitude = fabsl(truncl(input));
+    bool negative = input < 0;
+    int exponent;
+    long double fraction = frexpl(magnitude, &exponent);
+    if (exponent <= 64) {
+        assignInteger((uint64_t) magnitude, negative, setbase);
+        return;
     }
-    
-    if (input < base) {
-        vec.push_back(input);
+    assignInteger((uint64_t) ldexpl(fraction, 64), negative, setbase);
+    if(setbase < 2 || setbase > 36){
+        return;
+    }
+    BigInt scale(2, base);
+    scale.exponentiation(BigInt(exponent - 64, base));
+    *this *= scale;
+}
+
+/*
+//  Splits [0, count) into 'blocks' contiguous blocks and calls
+//  f(j, first, last) for block j, each block on its own thread.
+//  textBlocks picks one block per thread when there is enough text
+//  to be worth a thread, and a single block otherwise.
+*/
+static const int TEXT_PARALLEL_THRESHOLD = 1 << 16;
+
+static int textBlocks(int count, unsigned threads){
+    if (threads <= 1 || count < (int) threads * TEXT_PARALLEL_THRESHOLD) {
+        return 1;
+    }
+    return threads;
+}
+
+template <typename F>
+static void forEachBlock(int count, int blocks, F f){
+    int block = (count + blocks - 1) / blocks;
+    if (blocks <= 1) {
+        f(0, 0, count);
+        return;
+    }
+    vector<thread> pool;
+    for (int j = 1; j * block < count; j++) {
+        pool.push_back(thread(f, j, j * block, min(count, (j + 1) * block)));
+    }
+    f(0, 0, min(count, block));
+    for (unsigned int i = 0; i < pool.size(); i++) {
+        pool[i].join();
     }
-    else {
-        while (input!= 0) {
-            vec.push_back(input % base);
-            input /= base;
-        }
-    }   
+}
+
+/*
+//  Value of a digit character ('0' - '9', 'A' - 'Z'), or -1 for any
+//  other character, which is skipped.
+*/
+static int digitValue(char c){
+    if (c > 64 && c < 91) {
+        return (int) c - 55;
+    }
+    if (c > 47 && c < 58) {
+        return (int) c - 48;
+    }
+    return -1;
 }
 
 /*
 //  Creates a BigInt from string with a specified base.
 //  Assumes that the string number input is in the same
 //      base as the setbase input.
+//  Huge strings can be parsed by several threads: each block of the
+//      string counts its digits first, which tells every block where
+//      its digits go, then all blocks write their digits at once.
 */
-BigInt::BigInt(const string &s, int setbase){
+BigInt::BigInt(const string &s, int setbase, unsigned threads){
     if(setbase < 2 || setbase > 36){
         cout << "Invalid Base Error";
         return;
@@ -72,28 +285,34 @@ BigInt::BigInt(const string &s, int setbase){
     base = setbase;
     
     //deal with negatives
-    if (s[0] == '-') {
-        isPositive = false;
-        for (int i = s.size() - 1; i > 0; i--) {
-            if (s[i] > 64 && s[i] < 91) {
-                vec.push_back((int) (s[i]) - 55);
-            }
-            else if (s[i] > 47 && s[i] < 58) {
-                vec.push_back((int) (s[i]) - 48);
-            }
-        }  
-    }
-    else {
-        isPositive = true;
-        for (int i = s.size() - 1; i >= 0; i--) {
-            if (s[i] > 64 && s[i] < 91) {
-                vec.push_back((int) (s[i]) - 55);
-            }
-            else if (s[i] > 47 && s[i] < 58) {
-                vec.push_back((int) (s[i]) - 48);
+    isPositive = s[0] != '-';
+    const char *text = s.data() + (isPositive ? 0 : 1);
+    int length = s.size() - (isPositive ? 0 : 1);
+    
+    int blocks = textBlocks(length, threads);
+    vector<int> counts(blocks + 1, 0);
+    forEachBlock(length, blocks, [&](int j, int first, int last) {
+        int found = 0;
+        for (int i = first; i < last; i++) {
+            found += digitValue(text[i]) >= 0;
+        }
+        counts[j + 1] = found;
+    });
+    partial_sum(counts.begin(), counts.end(), counts.begin());
+    
+    // The last character is the least significant digit
+    int total = counts[blocks];
+    vector<int> digits(total);
+    forEachBlock(length, blocks, [&](int j, int first, int last) {
+        int position = total - 1 - counts[j];
+        for (int i = first; i < last; i++) {
+            int digit = digitValue(text[i]);
+            if (digit >= 0) {
+                digits[position--] = digit;
             }
         }
-    }
+    });
+    vec = move(digits);
 }
 
 /*
@@ -112,21 +331,26 @@ BigInt::~BigInt(){}
 /*
 // Convert to string and return the string
 //  Displayed in its corresponding base
+//  Huge values can be written by several threads, each filling its own
+//      block of the string.
 */
-string BigInt::to_string(){
-
-    string output = "";
-    for (int i=vec.size() - 1; i >= 0; i--) {
-        if (vec[i] > 9) {
-            output += (char) (vec[i]) + 55;
-        }
-        else {
-            output += (char) (vec[i]) + 48; 
+string BigInt::to_string(unsigned threads) const{
+
+    int size = vec.size();
+    int sign = isPositive ? 0 : 1;
+    string output(size + sign, '-');
+    char *text = output.data() + sign;
+    const int *digits = vec.data();
+    forEachBlock(size, textBlocks(size, threads), [&](int, int first, int last) {
+        for (int i = first; i < last; i++) {
+            if (digits[i] > 9) {
+                text[size - 1 - i] = (char) (digits[i]) + 55;
+            }
+            else {
+                text[size - 1 - i] = (char) (digits[i]) + 48;
+            }
         }
-    }
-    if (!isPositive) {
-        output.insert(0, "-");
-    }
+    });
     return output;
 }
 
@@ -136,31 +360,278 @@ string BigInt::to_string(){
 //    If BigInt < INT_MIN, return INT_MIN.
 */
 int BigInt::to_int() const{
+    return saturated<int>();
+}
 
+/*
+//  Converts BigInt to a fixed width integer, saturating at the limits
+//  of the type like to_int. Negative values give 0 for unsigned types.
+//  Use fitsIn<T>() to check whether the conversion is exact.
+*/
+int64_t BigInt::to_int64() const{
+    return saturated<int64_t>();
+}
 
-    unsigned int total = 0;
-    int based = 1;
-    
-    // Do the math and coninuallly check if it is
-    // going passed the max/min
-    for (unsigned int i=0; i<vec.size(); i++) {
-        total+=(vec[i] * based);
-        based *= base; 
-        if (total > INT_MAX) {
-            if (isPositive){
-                return INT_MAX;
+uint64_t BigInt::to_uint64() const{
+    return saturated<uint64_t>();
+}
+
+__int128 BigInt::to_int128() const{
+    return saturated<__int128>();
+}
+
+unsigned __int128 BigInt::to_uint128() const{
+    return saturated<unsigned __int128>();
+}
+
+/*
+//  Converts BigInt to the nearest double (ties to even).
+//    Values too large for the type give +/- infinity.
+*/
+double BigInt::to_double() const{
+    unsigned __int128 m;
+    double result;
+    if (magnitude128(m)) {
+        result = (double) m;
+    }
+    else {
+        int shift;
+        unsigned __int128 top = leadingBits(DBL_MAX_EXP, shift);
+        result = ldexp((double) top, shift);
+    }
+    return isPositive ? result : -result;
+}
+
+long double BigInt::to_long_double() const{
+    unsigned __int128 m;
+    long double result;
+    if (magnitude128(m)) {
+        result = (long double) m;
+    }
+    else {
+        int shift;
+        unsigned __int128 top = leadingBits(LDBL_MAX_EXP, shift);
+        result = ldexpl((long double) top, shift);
+    }
+    return isPositive ? result : -result;
+}
+
+/*
+//  Reads |BigInt| into m by Horner's rule, most significant digit first.
+//    Returns false (with m set to the all ones value) once the value
+//    no longer fits in 128 bits.
+*/
+bool BigInt::magnitude128(unsigned __int128 &m) const{
+    const unsigned __int128 limit = ~(unsigned __int128) 0;
+    m = 0;
+    for (int i = vec.size() - 1; i >= 0; i--) {
+        if (m > (limit - vec[i]) / base) {
+            m = limit;
+            return false;
+        }
+        m = m * base + vec[i];
+    }
+    return true;
+}
+
+/*
+//  Returns the top 128 bits of |BigInt| and sets shift so that
+//  |BigInt| is about top * 2^shift, for values that do not fit in 128 bits.
+//    - The lowest bit of top is or'ed with every bit below it (a sticky
+//      bit), so rounding top to 53 or 64 bits rounds the full value
+//      correctly.
+//    - Values certain to exceed 2^maxBits skip the conversion to base 2
+//      and get a shift large enough to overflow to infinity.
+*/
+unsigned __int128 BigInt::leadingBits(int maxBits, int &shift) const{
+    int bitsPerDigit = 0;
+    while ((2 << bitsPerDigit) <= base) {
+        bitsPerDigit++;
+    }
+    if ((long long) (normalizedSize() - 1) * bitsPerDigit > maxBits) {
+        shift = INT_MAX / 2;
+        return 1;
+    }
+
+    BigInt binary = toBase(2);
+    int length = binary.normalizedSize();
+    unsigned __int128 top = 0;
+    for (int i = length - 1; i >= length - 128; i--) {
+        top = (top << 1) | binary.vec[i];
+    }
+    for (int i = length - 129; i >= 0; i--) {
+        if (binary.vec[i] != 0) {
+            top |= 1;
+            break;
+        }
+    }
+    shift = length - 128;
+    return top;
+}
+
+/*
+//  Converts digits[0..count) of base 'from' into a BigInt of base 'to'.
+//    - The digits are split at a power of two, high * from^(2^k) + low,
+//      so every level of the recursion reuses powers[k] = from^(2^k)
+//      (already in base 'to', from the shared cache), and the combining multiplications are
+//      balanced enough for Karatsuba.
+//    - Short runs are evaluated by Horner's rule, a word-sized chunk of
+//      digits at a time, with the scalar kernels.
+//    - With threads > 1 the two halves are converted concurrently; the
+//      high half's thread also does its multiplication by the power.
+*/
+static const int RADIX_CONVERSION_LEAF = 32;
+static const int RADIX_PARALLEL_THRESHOLD = 2048;
+static atomic<int> radixConversionLeaf(RADIX_CONVERSION_LEAF);
+
+static BigInt convertDigits(const int *digits, int count, int from, int to,
+                            const vector<const BigInt *> &powers, unsigned threads){
+    if (count <= radixConversionLeaf.load(memory_order_relaxed)) {
+        // Largest chunk of digits whose value stays below 2^58
+        int chunk = 1;
+        uint64_t chunkpower = from;
+        while (chunkpower <= (1ULL << 58) / from) {
+            chunkpower *= from;
+            chunk++;
+        }
+        BigInt result(0, to);
+        for (int top = count; top > 0; top -= chunk) {
+            int bottom = max(0, top - chunk);
+            uint64_t value = 0;
+            uint64_t scale = 1;
+            for (int i = top - 1; i >= bottom; i--) {
+                value = value * from + digits[i];
+                scale *= from;
             }
-            else {
-                return INT_MIN;
+            result *= scale;
+            result += value;
+        }
+        return result;
+    }
+    
+    int k = 0;
+    while ((2 << k) < count) {
+        k++;
+    }
+    int split = 1 << k;
+    if (threads > 1 && count >= RADIX_PARALLEL_THRESHOLD) {
+        future<BigInt> high = async(launch::async, [=, &powers]() {
+            BigInt result = convertDigits(digits + split, count - split, from, to,
+                                          powers, threads / 2);
+            return result *= *powers[k];
+        });
+        BigInt low = convertDigits(digits, split, from, to, powers, threads - threads / 2);
+        BigInt result = high.get();
+        return result += low;
+    }
+    BigInt result = convertDigits(digits + split, count - split, from, to, powers, 1);
+    result *= *powers[k];
+    result += convertDigits(digits, split, from, to, powers, 1);
+    return result;
+}
+
+/*
+//  Returns pointers to base^(2^k), written in base 'to', for k < levels.
+//    - The powers live in a cache shared by every conversion and thread.
+//      It only ever grows, and a deque never moves its elements, so the
+//      returned pointers stay valid while other threads extend it.
+//    - Missing powers are squared outside the lock, which is only held
+//      exclusively to append them, so growing one cache never stalls
+//      conversions between other bases (or readers of this one).
+//    - The cache is never freed. Each (from, to) pair keeps the powers
+//      for the largest value converted so far, which add up to about
+//      twice the size of that value.
+*/
+static vector<const BigInt *> radixPowers(int from, int to, int levels){
+    static shared_mutex lock;
+    static deque<BigInt> cache[37][37];
+    deque<BigInt> &powers = cache[from][to];
+    
+    int have;
+    BigInt largest(0, to);
+    {
+        shared_lock<shared_mutex> reader(lock);
+        have = powers.size();
+        if (have >= levels) {
+            vector<const BigInt *> result;
+            for (int k = 0; k < levels; k++) {
+                result.push_back(&powers[k]);
             }
-        }        
+            return result;
+        }
+        if (have > 0) {
+            largest = powers.back();
+        }
     }
     
-    // Convert it to negative if it is negative
-    if (!isPositive) {
-        total *= -1;
+    // Square up from the largest cached power without holding the lock
+    vector<BigInt> missing;
+    if (have == 0) {
+        largest += from;
+        missing.push_back(largest);
+    }
+    while (have + (int) missing.size() < levels) {
+        missing.push_back(largest.square());
+    }
+    
+    // Another thread may have appended some of them in the meantime
+    unique_lock<shared_mutex> writer(lock);
+    for (int k = powers.size(); k < levels; k++) {
+        powers.push_back(missing[k - have]);
+    }
+    vector<const BigInt *> result;
+    for (int k = 0; k < levels; k++) {
+        result.push_back(&powers[k]);
+    }
+    return result;
+}
+
+/*
+//  Returns this value converted to another base (2 - 36).
+//    - Subquadratic: a divide and conquer split over the digits, see
+//      convertDigits above.
+//    - threads > 1 converts independent subtrees of the split concurrently.
+*/
+BigInt BigInt::toBase(int newBase, unsigned threads) const{
+    if(newBase < 2 || newBase > 36 || base < 2 || base > 36 || vec.size() == 0){
+        cout << "Invalid Base Error";
+        return *this;
+    }
+    if (newBase == base) {
+        return *this;
+    }
+    int size = vec.size();
+    while (size > 1 && vec[size - 1] == 0) {
+        size--;
     }
-    return total;  
+    
+    // powers[k] = base^(2^k) written in the new base
+    int levels = 1;
+    while ((1 << levels) < size) {
+        levels++;
+    }
+    vector<const BigInt *> powers = radixPowers(base, newBase, levels);
+    
+    BigInt result = convertDigits(vec.data(), size, base, newBase, powers, threads);
+    if (!(result.vec.size() == 1 && result.vec[0] == 0)) {
+        result.isPositive = isPositive;
+    }
+    return result;
+}
+
+int BigInt::getBase() const{
+    return base;
+}
+
+/*
+//  Converts b into newBase for the mixed base paths of the operators.
+//    - Returns false, after toBase's Invalid Base Error, when either
+//      base is invalid or b has no digits, so that such a value is
+//      rejected instead of being read as 0.
+*/
+bool BigInt::convertBase(const BigInt &b, int newBase, BigInt &converted){
+    converted = b.toBase(newBase);
+    return converted.base == newBase && newBase >= 2 && newBase <= 36;
 }
 
 /*
@@ -168,91 +639,108 @@ int BigInt::to_int() const{
 //     If a = b, return 0.
 //     If a < b, return -1.
 //     If a > b, return 1.
+//  If b is in another base it is converted to a's base first.
 */
 int BigInt::compare(const BigInt &b) const{
     if(base != b.base){
-        cout << "Invalid Base Error";
-        return 10000000;
-    }
-    /************* You complete *************/
-    bool asizegreater;
-    bool different_sized = false;
-    vector <int> smallersized;
-    vector <int> biggersized;
-    
-    // Sets the values of smallersized and biggersized vectors
-    // to be used to analyze whether they could be the same if 
-    // you disregard leading zeroes
-    if (b.vec.size() != vec.size()){
-        different_sized = true;
-        if (b.vec.size() > vec.size()) {
-            asizegreater = false;
-             smallersized = vec;
-             biggersized = b.vec;
-        }
-        else {
-            asizegreater = true;
-             smallersized = b.vec;
-             biggersized = vec;
+        BigInt converted;
+        if (!convertBase(b, base, converted)) {
+            return 10000000;
         }
+        return compare(converted);
+    }
+    int a_size = normalizedSize();
+    int b_size = b.normalizedSize();
+    bool a_zero = a_size == 0 || (a_size == 1 && vec[0] == 0);
+    bool b_zero = b_size == 0 || (b_size == 1 && b.vec[0] == 0);
+    if (a_zero && b_zero) {
+        return 0;
     }
     
-    // Make sure all the values in the size difference are zeroes, else
-    // return the proper value
-    if (different_sized) {
-        for (unsigned int i=smallersized.size(); i < biggersized.size(); i++) {
-            if (biggersized[i] != 0) {
-                if ((!asizegreater && b.isPositive) ||
-                    (asizegreater && !isPositive)) {
-                    return -1;
-                }
-                else {
-                    return 1;
-                }
-            }
+    // Different signs decide it without looking at the digits
+    bool a_positive = isPositive || a_zero;
+    bool b_positive = b.isPositive || b_zero;
+    if (a_positive != b_positive) {
+        return a_positive ? 1 : -1;
+    }
+    
+    // Same sign: compare magnitudes, flipping the answer for negatives
+    int sign = a_positive ? 1 : -1;
+    if (a_size != b_size) {
+        return a_size > b_size ? sign : -sign;
+    }
+    const int *a_digits = vec.data();
+    const int *b_digits = b.vec.data();
+    for (int i = a_size - 1; i >= 0; i--) {
+        if (a_digits[i] != b_digits[i]) {
+            return a_digits[i] > b_digits[i] ? sign : -sign;
         }
     }
-    else {
-        smallersized = vec;
+    return 0;
+}
+
+/*
+//  Number of digits ignoring leading zeroes (O(1) for normalized values).
+*/
+int BigInt::normalizedSize() const{
+    int size = vec.size();
+    while (size > 1 && vec[size - 1] == 0) {
+        size--;
     }
-    
+    return size;
+}
 
-    // Check from right to left, ignoring leading zeroes
-    for (int i = smallersized.size() - 1; i >=0; i--) {
-        if (b.vec[i] > vec[i]) {
-            if (b.isPositive) {
-                return -1;
-            }
-            else {
-                return 1;
-            } 
-        }
-        else if (vec[i] > b.vec[i]) {
-            if (isPositive) {
-                return 1;
-            }
-            else {
-                return -1;
-            }
-        }
+/*
+//  Hash of the value (not of its digits), so equal values in different
+//  bases hash alike.
+//    - The value is reduced modulo the prime 2^61 - 1 by Horner's rule,
+//      taking several digits per multiplication.
+*/
+size_t BigInt::hash() const{
+    const uint64_t prime = (1ULL << 61) - 1;
+    int size = normalizedSize();
+    const int *digits = vec.data();
+    
+    // Largest chunk of digits whose value stays below 2^32
+    int chunk = 1;
+    uint64_t chunkpower = base;
+    while (chunkpower * base < (1ULL << 32)) {
+        chunkpower *= base;
+        chunk++;
     }
     
-    // If the magnitudes are equal, check the sign
-    if ((isPositive == b.isPositive)) {
-        return 0;
+    uint64_t value = 0;
+    for (int top = size; top > 0; top -= chunk) {
+        int bottom = max(0, top - chunk);
+        uint64_t part = 0;
+        uint64_t scale = 1;
+        for (int i = top - 1; i >= bottom; i--) {
+            part = part * base + digits[i];
+            scale *= base;
+        }
+        unsigned __int128 product = (unsigned __int128) value * scale + part;
+        value = (uint64_t) (product & prime) + (uint64_t) (product >> 61);
+        value = (value & prime) + (value >> 61);
     }
-    else if (isPositive) {
-        return 1;
+    if (value >= prime) {
+        value -= prime;
     }
-    else {
-        return -1;
+    if (value == 0) {
+        return 0;
     }
+    
+    // splitmix64 finalizer spreads the residue over all bits
+    uint64_t h = value ^ (isPositive ? 0 : 0x9E3779B97F4A7C15ULL);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
 }
 
 
 
 /*
 //  Assignment operator. (i.e., BigInt a = b;)
+//    - O(1): a shares b's digits until one of them is modified.
 */
 const BigInt & BigInt::operator = (const BigInt &b){
 
@@ -269,8 +757,11 @@ const BigInt & BigInt::operator = (const BigInt &b){
 */
 const BigInt & BigInt::operator += (const BigInt &b){
     if(base != b.base){
-        cout << "Invalid Base Exception";
-        return *this;
+        BigInt converted;
+        if (!convertBase(b, base, converted)) {
+            return *this;
+        }
+        return *this += converted;
     }
     
     // The primary function deals with the subtraction of two positive
@@ -301,30 +792,35 @@ const BigInt & BigInt::operator += (const BigInt &b){
           }              
       }
       
+      // Room for the final carry, so the loop can work on raw digits
+      vec.push_back(0);
+      int *digits = vec.data();
+      const int *addend = b.vec.data();
+      
       for (int i=0; i<a_size; i++) {
           int a_addend, b_addend;
           
           // Deals with different lengths
-          a_addend = vec[i];
+          a_addend = digits[i];
           if (i >= b_size) {
               b_addend = 0;
           }
           else {
-              b_addend = b.vec[i];
+              b_addend = addend[i];
           }
           
           // Does the adition and carries a 1 if necessary
           if ((a_addend + b_addend) < base) {
-            vec[i] = a_addend + b_addend;
+            digits[i] = a_addend + b_addend;
           }
           else {
-              if (i+1 >= a_size) {
-                  vec.push_back(0);
-              }
-              vec[i] = a_addend + b_addend - base;
-              vec[i+1]++;   
+              digits[i] = a_addend + b_addend - base;
+              digits[i+1]++;   
           }
       }
+      if (vec.back() == 0) {
+          vec.pop_back();
+      }
       return *this;
   }
     
@@ -354,9 +850,11 @@ const BigInt & BigInt::operator += (const BigInt &b){
 */
 const BigInt & BigInt::operator -= (const BigInt &b){
     if(base != b.base){
-
-        cout << "Invalid Base Error";
-        return *this;
+        BigInt converted;
+        if (!convertBase(b, base, converted)) {
+            return *this;
+        }
+        return *this -= converted;
     }
 
     BigInt copyofB = b;
@@ -404,21 +902,23 @@ const BigInt & BigInt::operator -= (const BigInt &b){
         }
         // Does the real subtraction math
         if (a_longer) {
+            int *digits = vec.data();
+            const int *subtrahend = b.vec.data();
             for (int i=0; i<longest_size; i++) {
                 int bottom_value, top_value;
-                top_value = vec[i];
+                top_value = digits[i];
                 if (i >= b_size) {
                     bottom_value = 0;
                 }
                 else {
-                    bottom_value = b.vec[i];
+                    bottom_value = subtrahend[i];
                 }
                 if ( top_value - bottom_value >= 0) {
-                    vec[i] -= bottom_value;
+                    digits[i] -= bottom_value;
                 }
                 else {
-                    vec[i] = top_value - bottom_value + base;
-                    (vec[i+1])--;
+                    digits[i] = top_value - bottom_value + base;
+                    (digits[i+1])--;
                 }
             }
             
@@ -450,36 +950,279 @@ const BigInt & BigInt::operator -= (const BigInt &b){
 }
 
 /*
-//  Multiplication assignment operator.
-//    - Compute a = a * b;
+//  Cancellation and progress checkpoints for asynchronous operations.
+//    - A job started by one of the *Async functions installs its options
+//      on the worker thread. Without one, a checkpoint is a single
+//      thread_local test, so synchronous callers pay nothing noticeable.
+//    - Progress is a window [low, low + width) of the whole job. Each
+//      loop gives its iterations equal slices of the current window
+//      (ProgressSteps), so nested work such as the products inside pow
+//      reports a fraction of the outer step it belongs to.
 */
-const BigInt & BigInt::operator *= (const BigInt &b){
-    if(base != b.base){
-        
-        cout << "Invalid Base Error";
-        return *this;
+struct ProgressState {
+    const AsyncOptions *options;
+    double low;
+    double width;
+    double reported;
+};
+
+static thread_local ProgressState *activeProgress = nullptr;
+
+static void checkpoint(long long done, long long total){
+    ProgressState *state = activeProgress;
+    if (state == nullptr) {
+        return;
+    }
+    if (state->options->token.cancelled()) {
+        throw OperationCancelled();
     }
+    if (state->options->progress) {
+        double position = state->low + state->width * done / total;
+        if (position >= state->reported + 0.01) {
+            state->reported = position;
+            state->options->progress(position);
+        }
+    }
+}
 
-    int a_size = vec.size();
-    int b_size = b.vec.size();
+class ProgressSteps {
+  public:
+    ProgressSteps(long long parts) : state(activeProgress), parts(parts) {
+        checkpoint(0, 1);
+        if (state != nullptr) {
+            low = state->low;
+            width = state->width;
+            state->width = width / parts;
+        }
+    }
+    ~ProgressSteps() {
+        if (state != nullptr) {
+            state->low = low;
+            state->width = width;
+        }
+    }
+    // Moves on to the next of the parts, which is also a checkpoint
+    void next() {
+        if (state != nullptr && part + 1 < parts) {
+            part++;
+            state->low = low + width * part / parts;
+        }
+        checkpoint(0, 1);
+    }
+
+  private:
+    ProgressState *state;
+    long long parts;
+    long long part = 0;
+    double low = 0;
+    double width = 0;
+};
+
+/*
+//  Squares the polynomial whose coefficients are a[0..n) into
+//  out[0..2n-1), leaving the carries for the caller.
+//    - Small inputs use schoolbook, computing each cross term a[i]a[j]
+//      once and doubling it.
+//    - Large inputs use Karatsuba: three half-size squares, with the
+//      middle term recovered as (a0 + a1)^2 - a0^2 - a1^2.
+*/
+static const int KARATSUBA_SQUARE_THRESHOLD = 48;
+static atomic<int> karatsubaSquareThreshold(KARATSUBA_SQUARE_THRESHOLD);
+
+static void squareCoefficients(const long long *a, int n, long long *out){
+    if (n < karatsubaSquareThreshold.load(memory_order_relaxed)) {
+        for (int i = 0; i < 2 * n - 1; i++) {
+            out[i] = 0;
+        }
+        for (int i = 0; i < n; i++) {
+            out[2 * i] += a[i] * a[i];
+            long long doubled = 2 * a[i];
+            for (int j = i + 1; j < n; j++) {
+                out[i + j] += doubled * a[j];
+            }
+        }
+        return;
+    }
+    
+    int low = n / 2;
+    int high = n - low;
+    vector<long long> sum(a + low, a + n);
+    for (int i = 0; i < low; i++) {
+        sum[i] += a[i];
+    }
+    vector<long long> z0(2 * low - 1);
+    vector<long long> z1(2 * high - 1);
+    ProgressSteps step(3);
+    squareCoefficients(a, low, z0.data());
+    step.next();
+    squareCoefficients(a + low, high, out + 2 * low);
+    step.next();
+    squareCoefficients(sum.data(), high, z1.data());
+    
+    // out holds z0 in the low half and z2 in the high half, with the
+    // coefficient between them untouched by either
+    for (int i = 0; i < 2 * low - 1; i++) {
+        out[i] = z0[i];
+    }
+    out[2 * low - 1] = 0;
+    for (int i = 0; i < 2 * high - 1; i++) {
+        z1[i] -= out[2 * low + i];
+        if (i < 2 * low - 1) {
+            z1[i] -= z0[i];
+        }
+        out[low + i] += z1[i];
+    }
+}
+
+/*
+//  Multiplies the polynomials a[0..n) and b[0..m) into out[0..n+m-1),
+//  leaving the carries for the caller.
+//    - Small inputs use schoolbook.
+//    - Equal-length inputs use Karatsuba: three half-size products, with
+//      the middle term recovered as (a0 + a1)(b0 + b1) - a0b0 - a1b1.
+//    - Unbalanced inputs are cut into chunks the size of the shorter one.
+*/
+static const int KARATSUBA_MULTIPLY_THRESHOLD = 40;
+static atomic<int> karatsubaMultiplyThreshold(KARATSUBA_MULTIPLY_THRESHOLD);
+
+static void multiplyCoefficients(const long long *a, int n, const long long *b, int m, long long *out){
+    if (n < m) {
+        multiplyCoefficients(b, m, a, n, out);
+        return;
+    }
+    for (int i = 0; i < n + m - 1; i++) {
+        out[i] = 0;
+    }
+    if (m < karatsubaMultiplyThreshold.load(memory_order_relaxed)) {
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < m; j++) {
+                out[i + j] += a[i] * b[j];
+            }
+        }
+        return;
+    }
+    if (n > m) {
+        vector<long long> chunk(2 * m - 1);
+        ProgressSteps step((n + m - 1) / m);
+        for (int start = 0; start < n; start += m) {
+            int length = min(m, n - start);
+            multiplyCoefficients(a + start, length, b, m, chunk.data());
+            for (int i = 0; i < length + m - 1; i++) {
+                out[start + i] += chunk[i];
+            }
+            step.next();
+        }
+        return;
+    }
+    
+    int low = n / 2;
+    int high = n - low;
+    vector<long long> sumA(a + low, a + n);
+    vector<long long> sumB(b + low, b + n);
+    for (int i = 0; i < low; i++) {
+        sumA[i] += a[i];
+        sumB[i] += b[i];
+    }
+    vector<long long> z0(2 * low - 1);
+    vector<long long> z1(2 * high - 1);
+    ProgressSteps step(3);
+    multiplyCoefficients(a, low, b, low, z0.data());
+    step.next();
+    multiplyCoefficients(a + low, high, b + low, high, out + 2 * low);
+    step.next();
+    multiplyCoefficients(sumA.data(), high, sumB.data(), high, z1.data());
+    
+    // out holds z0 in the low half and z2 in the high half, with the
+    // coefficient between them untouched by either
+    for (int i = 0; i < 2 * low - 1; i++) {
+        out[i] = z0[i];
+    }
+    out[2 * low - 1] = 0;
+    for (int i = 0; i < 2 * high - 1; i++) {
+        z1[i] -= out[2 * low + i];
+        if (i < 2 * low - 1) {
+            z1[i] -= z0[i];
+        }
+        out[low + i] += z1[i];
+    }
+}
+
+/*
+//  Multiplication assignment operator.
+//    - Compute a = a * b;
+*/
+const BigInt & BigInt::operator *= (const BigInt &b){
+    if(base != b.base){
+        BigInt converted;
+        if (!convertBase(b, base, converted)) {
+            return *this;
+        }
+        return *this *= converted;
+    }
+    
+    // Equal operands go through the cheaper squaring kernel
+    if (&b == this || (isPositive == b.isPositive && vec == b.vec)) {
+        return square();
+    }
+
+    // Read the digits through a const view, since vec is replaced
+    // wholesale at the end and a shared buffer must not be copied first
+    const DigitBuffer &a_vec = vec;
+    int a_size = a_vec.size();
+    int b_size = b.vec.size();
+    
+    // Large operands go through Karatsuba on the trimmed digits
+    while (a_size > 1 && a_vec[a_size - 1] == 0) {
+        a_size--;
+    }
+    while (b_size > 1 && b.vec[b_size - 1] == 0) {
+        b_size--;
+    }
+    if (min(a_size, b_size) >= karatsubaMultiplyThreshold.load(memory_order_relaxed)) {
+        vector<long long> a_digits(a_vec.begin(), a_vec.begin() + a_size);
+        vector<long long> b_digits(b.vec.begin(), b.vec.begin() + b_size);
+        vector<long long> coefficients(a_size + b_size - 1);
+        multiplyCoefficients(a_digits.data(), a_size, b_digits.data(), b_size,
+                             coefficients.data());
+        
+        vec.assign(a_size + b_size, 0);
+        long long carry = 0;
+        for (int i = 0; i < a_size + b_size; i++) {
+            if (i < a_size + b_size - 1) {
+                carry += coefficients[i];
+            }
+            vec[i] = carry % base;
+            carry /= base;
+        }
+        while (vec.size() > 1 && vec.back() == 0) {
+            vec.pop_back();
+        }
+        isPositive = (isPositive == b.isPositive);
+        return *this;
+    }
+    a_size = a_vec.size();
+    b_size = b.vec.size();
     vector<int>outputvector(a_size + b_size, 0);
     int outputvindex = 0;
+    const int *top = a_vec.data();
+    const int *bottom = b.vec.data();
     
     // Carry keeps track of all of the numbers that have to be carried for 
     // each digit on the bottom
     
     for (int b_i=0; b_i < a_size;
          b_i++, outputvindex++) {
+        checkpoint(b_i, a_size);
         int carry = 0;
         for (int t_i = 0; t_i < b_size; t_i++) {
-            if (vec[b_i] * b.vec[t_i] + carry < base) {
+            if (top[b_i] * bottom[t_i] + carry < base) {
                 outputvector[t_i + outputvindex] 
-                    += vec[b_i] * b.vec[t_i] + carry; 
+                    += top[b_i] * bottom[t_i] + carry; 
                 carry = 0;
             }
             else {
                 // Update carry variable
-                int value = vec[b_i] * b.vec[t_i] + carry;
+                int value = top[b_i] * bottom[t_i] + carry;
                 carry = value / base;
                 if (t_i + 1 == b_size) {
                     outputvector[t_i + outputvindex+ 1] = carry;
@@ -523,7 +1266,7 @@ const BigInt & BigInt::operator *= (const BigInt &b){
         }
     }
     // Copy ouput vector to *this
-    vec = outputvector;
+    vec = std::move(outputvector);
     
 
     
@@ -536,9 +1279,11 @@ const BigInt & BigInt::operator *= (const BigInt &b){
 */
 const BigInt & BigInt::operator /= (const BigInt &b){
     if(base != b.base){
-
-        cout << "Invalid Base Error";
-        return *this;
+        BigInt converted;
+        if (!convertBase(b, base, converted)) {
+            return *this;
+        }
+        return *this /= converted;
     }
     if(b.vec.size() == 1 && b.vec[0] == 0){
         cout << "Dividing by Zero Error";
@@ -560,8 +1305,11 @@ const BigInt & BigInt::operator /= (const BigInt &b){
 */
 const BigInt & BigInt::operator %= (const BigInt &b){
     if(base != b.base){
-        cout << "Invalid Base Error";
-        return *this;
+        BigInt converted;
+        if (!convertBase(b, base, converted)) {
+            return *this;
+        }
+        return *this %= converted;
     }
     if(b.vec.size() == 1 && b.vec[0] == 0){
         cout << "Dividing by Zero Error";
@@ -588,9 +1336,18 @@ const BigInt & BigInt::operator %= (const BigInt &b){
 //  Computes (q)uotient and (r)emainder: a = (b * q) + r.
 */
 void BigInt::divisionMain(const BigInt &b, BigInt &quotient, BigInt &remainder){
+    if(base != b.base){
+        BigInt converted;
+        if (convertBase(b, base, converted)) {
+            divisionMain(converted, quotient, remainder);
+        }
+        return;
+    }
 
     /************* You complete *************/
-    int a_size = vec.size();
+    // The dividend is only read, so a shared buffer is never copied
+    const DigitBuffer &a_vec = vec;
+    int a_size = a_vec.size();
     int b_size = b.vec.size();
     
     // Return 0 if b's magnitude is greater than a's
@@ -605,22 +1362,21 @@ void BigInt::divisionMain(const BigInt &b, BigInt &quotient, BigInt &remainder){
     else if (b_size == a_size) {  
          for (int i = a_size - 1; i >= 0; i--) {
              // If b's magnitude is greater than a's return 0
-             if (vec[i] < b.vec[i]) {
+             if (a_vec[i] < b.vec[i]) {
                 vector<int> zero (1, 0);
                 quotient.vec = zero;
                 quotient.isPositive = true;
                 remainder.vec = vec;
                 return;
              }
-             else if (vec[i] > b.vec[i]) {
+             else if (a_vec[i] > b.vec[i]) {
                  break;
              }
              
          }
     }
     
-    BigInt tempdividend(base);
-    BigInt basemultiply(base, base);
+    BigInt tempdividend(0, base);
     BigInt positiveB = b;
     positiveB.isPositive = true;
     int dividend_index = a_size - 1;
@@ -632,8 +1388,14 @@ void BigInt::divisionMain(const BigInt &b, BigInt &quotient, BigInt &remainder){
     // to the divisor or positiveB
     
     while (dividend_index >= 0) {
-        tempdividend *= basemultiply;
-        tempdividend.vec[0] = vec[dividend_index];
+        checkpoint(a_size - 1 - dividend_index, a_size);
+        // Shift the temporary dividend up a digit and bring down the next
+        if (tempdividend.vec.size() == 1 && tempdividend.vec[0] == 0) {
+            tempdividend.vec[0] = a_vec[dividend_index];
+        }
+        else {
+            tempdividend.vec.insert(0, a_vec[dividend_index]);
+        }
         dividend_index--;
         if (tempdividend.compare(positiveB) == -1) {
             //if adding another digit to the front part of the
@@ -675,14 +1437,52 @@ void BigInt::divisionMain(const BigInt &b, BigInt &quotient, BigInt &remainder){
 }
 
 
+/*
+//  Squaring assignment function.
+//  Computes a = a * a, about half the work of a general multiply.
+*/
+const BigInt & BigInt::square(){
+    if (vec.empty()) {
+        vec.push_back(0);
+    }
+    const DigitBuffer &a_vec = vec;
+    int size = a_vec.size();
+    while (size > 1 && a_vec[size - 1] == 0) {
+        size--;
+    }
+    
+    vector<long long> digits(a_vec.begin(), a_vec.begin() + size);
+    vector<long long> coefficients(2 * size - 1);
+    squareCoefficients(digits.data(), size, coefficients.data());
+    
+    // Carry the coefficients back into digits
+    vec.assign(2 * size, 0);
+    long long carry = 0;
+    for (int i = 0; i < 2 * size; i++) {
+        if (i < 2 * size - 1) {
+            carry += coefficients[i];
+        }
+        vec[i] = carry % base;
+        carry /= base;
+    }
+    while (vec.size() > 1 && vec.back() == 0) {
+        vec.pop_back();
+    }
+    isPositive = true;
+    return *this;
+}
+
 /*
 //  Exponentiation assignment function.
 //  Computes a BigInt whose value is a = pow(a,b).
 */
 const BigInt & BigInt::exponentiation(const BigInt &b){
     if(base != b.base){
-        cout << "Invalid Base Error";
-        return *this;
+        BigInt converted;
+        if (!convertBase(b, base, converted)) {
+            return *this;
+        }
+        return exponentiation(converted);
     }
     if(!b.isPositive){
         cout << "Dividing by Zero Error";
@@ -702,27 +1502,25 @@ const BigInt & BigInt::exponentiation(const BigInt &b){
             return *this;
         }
     }
-    bool even;
-    BigInt two (2, base);
-    if ((b % two).to_int() == 0) {
-        even = true;
-    }
-    else {
-        even = false;
-    }
-    int power = (b / two).to_int();
-    BigInt asquared = *this * *this;
-    BigInt cleanslate = asquared;
-
-        
-    for (int i=0; i < power - 1; i++) {
-        cleanslate *= asquared;
-    }
-    if (!even) {
-        *this *= cleanslate;
-    }
-    else {
-        *this = cleanslate;
+    // Square and multiply, reading the exponent's bits off with
+    // scalar division by 2
+    BigInt n = b;
+    BigInt power = *this;
+    vector<int>one (1, 1);
+    vec = one;
+    isPositive = true;
+    
+    // One step per bit of the exponent
+    ProgressSteps step((long long) (b.vec.size() * log2(base)) + 1);
+    while (true) {
+        if (n.divideScalar(2, false) == 1) {
+            *this *= power;
+        }
+        if (n.vec.size() == 1 && n.vec[0] == 0) {
+            break;
+        }
+        power.square();
+        step.next();
     }
     return *this;
 }
@@ -733,8 +1531,11 @@ const BigInt & BigInt::exponentiation(const BigInt &b){
 */
 const BigInt & BigInt::modulusExp(const BigInt &b, const BigInt &m){
     if(base != b.base || base != m.base){
-        cout << "Invalid Base Error";
-        return *this;
+        BigInt exponent, modulus;
+        if (!convertBase(b, base, exponent) || !convertBase(m, base, modulus)) {
+            return *this;
+        }
+        return modulusExp(exponent, modulus);
     }
     if(!b.isPositive){
         cout << "No Negative Exponents";
@@ -749,42 +1550,334 @@ const BigInt & BigInt::modulusExp(const BigInt &b, const BigInt &m){
             return *this;
         }
         else if (b.vec[0] == 1) {
-            *this %= b;
+            *this %= m;
+            isPositive = true;
             return *this;
         }
     }
 
-    BigInt two (2, base);
-    BigInt one (1, base);
+    BigInt modulus = m;
+    modulus.isPositive = true;
+    BigInt power = *this % modulus;
+    power.isPositive = true;
+    
+    // Moduli sharing no factor with the base reduce with Montgomery
+    // multiplication instead of a long division per step
+    if (gcd(modulus.vec[0], base) == 1) {
+        MontgomeryContext context(modulus);
+        *this = context.fromMontgomery(context.pow(context.toMontgomery(power), b));
+        isPositive = true;
+        return *this;
+    }
+    
+    // Otherwise square and multiply, reading the exponent's bits off
+    // with scalar division by 2
     BigInt n = b;
-    BigInt tempbase = *this;
     vector<int>onevec (1, 1);
     vec = onevec;
     
- 
-    while (true){
-        if ((n % two).to_int() == 0){
-
-            n /= two;
-   
-            tempbase = ((tempbase * tempbase) % m);
-           
+    // One step per bit of the exponent
+    ProgressSteps step((long long) (b.vec.size() * log2(base)) + 1);
+    while (true) {
+        if (n.divideScalar(2, false) == 1) {
+            *this *= power;
+            *this %= modulus;
         }
-        else if (n.to_int() == 1) {
+        if (n.vec.size() == 1 && n.vec[0] == 0) {
             break;
         }
-        else {
-            n -= one;
+        power.square();
+        power %= modulus;
+        step.next();
+    }
+    
+    isPositive = true;
+    return *this;
+}
+
+
+/*
+//  Writes the digits of a machine integer in the given base into 'out'
+//  (least significant first) and returns how many were written.
+//    - A uint64_t has at most 64 digits in any base >= 2, so callers
+//      can keep 'out' on the stack.
+*/
+static int scalarDigits(uint64_t m, int base, int *out){
+    int count = 0;
+    do {
+        out[count++] = m % base;
+        m /= base;
+    } while (m != 0);
+    return count;
+}
+
+/*
+//  Compares the magnitude of a with the digits of a scalar.
+//     If |a| = m, return 0.
+//     If |a| < m, return -1.
+//     If |a| > m, return 1.
+*/
+int BigInt::compareMagnitude(const int *digits, int count) const{
+    int size = vec.size();
+    
+    // Ignore leading zeroes
+    while (size > 1 && vec[size - 1] == 0) {
+        size--;
+    }
+    if (size > count) {
+        return 1;
+    }
+    if (size < count) {
+        return -1;
+    }
+    for (int i = size - 1; i >= 0; i--) {
+        if (vec[i] > digits[i]) {
+            return 1;
+        }
+        else if (vec[i] < digits[i]) {
+            return -1;
+        }
+    }
+    return 0;
+}
 
-            *this = ((*this *tempbase) % m);
-           
+/*
+//  Compares a with the machine integer sign * m, like compare above.
+*/
+int BigInt::compareScalar(uint64_t m, bool negative) const{
+    if(base < 2 || base > 36){
+        cout << "Invalid Base Error";
+        return 10000000;
+    }
+    int size = normalizedSize();
+    bool a_zero = size == 0 || (size == 1 && vec[0] == 0);
+    bool a_positive = isPositive || a_zero;
+    bool b_positive = !negative || m == 0;
+    if (a_positive != b_positive) {
+        return a_positive ? 1 : -1;
+    }
+    if (a_zero) {
+        return m == 0 ? 0 : -1;
+    }
+    int digits[64];
+    int count = scalarDigits(m, base, digits);
+    int order = compareMagnitude(digits, count);
+    return a_positive ? order : -order;
+}
+
+/*
+//  Scalar addition kernel shared by += and -=.
+//    - Computes a = a + m, or a = a - m if 'negative' is set, in one
+//      pass over a's digits without building a BigInt for m.
+*/
+const BigInt & BigInt::addScalar(uint64_t m, bool negative){
+    if (vec.empty()) {
+        vec.push_back(0);
+        isPositive = true;
+    }
+    if (m == 0) {
+        return *this;
+    }
+    
+    // Same signs add the magnitudes, carrying until the scalar runs out
+    if (isPositive != negative) {
+        uint64_t carry = m;
+        for (int i = 0; carry != 0; i++) {
+            if (i == (int) vec.size()) {
+                vec.push_back(0);
+            }
+            int sum = vec[i] + (int) (carry % base);
+            carry /= base;
+            if (sum >= base) {
+                sum -= base;
+                carry++;
+            }
+            vec[i] = sum;
         }
+        return *this;
     }
     
-    *this *= tempbase;
+    // Different signs subtract the smaller magnitude from the bigger one
+    int digits[64];
+    int count = scalarDigits(m, base, digits);
+    int order = compareMagnitude(digits, count);
+    if (order >= 0) {
+        int borrow = 0;
+        for (int i = 0; i < (int) vec.size() && (i < count || borrow); i++) {
+            int bottom_value = borrow;
+            if (i < count) {
+                bottom_value += digits[i];
+            }
+            if (vec[i] - bottom_value >= 0) {
+                vec[i] -= bottom_value;
+                borrow = 0;
+            }
+            else {
+                vec[i] = vec[i] - bottom_value + base;
+                borrow = 1;
+            }
+        }
+    }
+    else {
+        // |a| < m, so |a| fits in a uint64_t and m - |a| can be
+        // computed directly
+        uint64_t value = 0;
+        for (int i = vec.size() - 1; i >= 0; i--) {
+            value = value * base + vec[i];
+        }
+        count = scalarDigits(m - value, base, digits);
+        vec.assign(digits, digits + count);
+        isPositive = !negative;
+    }
     
-    *this %= m;
-    isPositive = true;
+    // Gets rid of all of the extra zeroes
+    while (vec.size() > 1 && vec.back() == 0) {
+        vec.pop_back();
+    }
+    if (vec.size() == 1 && vec[0] == 0) {
+        isPositive = true;
+    }
+    return *this;
+}
+
+/*
+//  Scalar multiplication kernel.
+//    - Computes a = a * m (negated if 'negative' is set) in one pass,
+//      carrying a machine word instead of a digit vector.
+*/
+const BigInt & BigInt::multiplyScalar(uint64_t m, bool negative){
+    if (vec.empty()) {
+        vec.push_back(0);
+        isPositive = true;
+    }
+    if (m == 0) {
+        vec.assign(1, 0);
+        isPositive = true;
+        return *this;
+    }
+    
+    // vec[i] * m + carry stays below 37 * m, so small multipliers can
+    // carry in 64 bits and only huge ones need 128
+    if (m < UINT64_MAX / 37) {
+        uint64_t carry = 0;
+        for (unsigned int i = 0; i < vec.size(); i++) {
+            uint64_t value = vec[i] * m + carry;
+            carry = value / base;
+            vec[i] = value - carry * base;
+        }
+        while (carry != 0) {
+            vec.push_back(carry % base);
+            carry /= base;
+        }
+    }
+    else {
+        unsigned __int128 carry = 0;
+        for (unsigned int i = 0; i < vec.size(); i++) {
+            unsigned __int128 value = (unsigned __int128) vec[i] * m + carry;
+            carry = value / base;
+            vec[i] = value - carry * base;
+        }
+        while (carry != 0) {
+            vec.push_back(carry % base);
+            carry /= base;
+        }
+    }
+    
+    // Deal with different signs
+    if (isPositive == !negative) {
+        isPositive = true;
+    }
+    else {
+        isPositive = false;
+    }
+    if (vec.size() == 1 && vec[0] == 0) {
+        isPositive = true;
+    }
+    return *this;
+}
+
+/*
+//  Scalar division kernel.
+//    - Computes a = a / m (negated if 'negative' is set) by short
+//      division and returns the magnitude of the remainder, which
+//      takes the sign of the dividend.
+*/
+uint64_t BigInt::divideScalar(uint64_t m, bool negative){
+    if (m == 0) {
+        cout << "Dividing by Zero Error";
+        return 0;
+    }
+    if (vec.empty()) {
+        vec.push_back(0);
+        isPositive = true;
+    }
+    
+    uint64_t remainder = 0;
+    if (m < UINT64_MAX / 36) {
+        for (int i = vec.size() - 1; i >= 0; i--) {
+            uint64_t value = remainder * base + vec[i];
+            vec[i] = value / m;
+            remainder = value - vec[i] * m;
+        }
+    }
+    else {
+        for (int i = vec.size() - 1; i >= 0; i--) {
+            unsigned __int128 value = (unsigned __int128) remainder * base + vec[i];
+            vec[i] = value / m;
+            remainder = value - (unsigned __int128) vec[i] * m;
+        }
+    }
+    
+    // Delete leading zeroes and deal with different signs
+    while (vec.size() > 1 && vec.back() == 0) {
+        vec.pop_back();
+    }
+    if (isPositive == !negative) {
+        isPositive = true;
+    }
+    else {
+        isPositive = false;
+    }
+    if (vec.size() == 1 && vec[0] == 0) {
+        isPositive = true;
+    }
+    return remainder;
+}
+
+/*
+//  Returns the magnitude of a % m without modifying a.
+*/
+uint64_t BigInt::remainderScalar(uint64_t m) const{
+    uint64_t remainder = 0;
+    if (m < UINT64_MAX / 36) {
+        for (int i = vec.size() - 1; i >= 0; i--) {
+            remainder = (remainder * base + vec[i]) % m;
+        }
+    }
+    else {
+        for (int i = vec.size() - 1; i >= 0; i--) {
+            remainder = ((unsigned __int128) remainder * base + vec[i]) % m;
+        }
+    }
+    return remainder;
+}
+
+/*
+//  Scalar modulus kernel.
+//    - Computes a = a % m. The remainder takes the sign of the dividend.
+*/
+const BigInt & BigInt::modulusScalar(uint64_t m){
+    if (m == 0) {
+        cout << "Dividing by Zero Error";
+        return *this;
+    }
+    
+    int digits[64];
+    int count = scalarDigits(remainderScalar(m), base, digits);
+    vec.assign(digits, digits + count);
+    if (count == 1 && digits[0] == 0) {
+        isPositive = true;
+    }
     return *this;
 }
 
@@ -833,6 +1926,13 @@ BigInt pow(const  BigInt &a, const BigInt & b){
   return temp.exponentiation(b);
 }
 
+//Calls the square function above to compute a BigInt whose value is a * a
+BigInt square(const BigInt &a){
+
+    BigInt temp = a;
+    return temp.square();
+}
+
 //Calls the modulusExp function above to compute a BigInt whose value is (a ^ b) mod c
 BigInt modPow(const BigInt &a, const BigInt &b, const BigInt &m){
 
@@ -840,26 +1940,42 @@ BigInt modPow(const BigInt &a, const BigInt &b, const BigInt &m){
     return temp.modulusExp(b, m);
 }
 
-//Calls the compare function above to check if a == b
+//Checks if a == b without ordering the digits: shared storage, sign and
+//length settle most cases before any digit is read
 bool operator == (const BigInt &a, const BigInt &b){
   
-    if (a.compare(b) == 0) {
+    if (a.base != b.base) {
+        return a.compare(b) == 0;
+    }
+    if (a.isPositive == b.isPositive && a.vec == b.vec) {
         return true;
     }
-    else {
-        return false;
+    
+    // Mismatched signs or lengths only tie when both are zero
+    int size = a.normalizedSize();
+    if (a.isPositive != b.isPositive || size != b.normalizedSize()) {
+        return size <= 1 && a.compare(b) == 0;
     }
+    return equal(a.vec.data(), a.vec.data() + size, b.vec.data());
 }
 
-//Calls the compare function above to check if a != b
+//Calls the == function above to check if a != b
 bool operator != (const BigInt &a, const BigInt &b){
   
-    if (a.compare(b) != 0) {
-        return true;
+    return !(a == b);
+}
+
+//Calls the compare function above to order a and b
+strong_ordering operator <=> (const BigInt &a, const BigInt &b){
+  
+    int order = a.compare(b);
+    if (order < 0) {
+        return strong_ordering::less;
     }
-    else {
-        return false;
+    if (order > 0) {
+        return strong_ordering::greater;
     }
+    return strong_ordering::equal;
 }
 
 //Calls the compare function above to check if a <= b
@@ -905,3 +2021,1672 @@ bool operator < (const BigInt &a, const BigInt &b){
         return false;
     }
 }
+
+
+//----------------------------------------------------
+//* Products of many values
+//----------------------------------------------------
+
+
+/*
+//  Multiplies values[low..high) as a balanced tree so that every
+//  multiplication has operands of similar size, which is what lets
+//  Karatsuba pay off. With threads > 1 the two halves of each node
+//  are computed concurrently.
+*/
+static BigInt productTree(span<const BigInt> values, unsigned threads){
+    if (values.size() == 1) {
+        return values[0];
+    }
+    size_t middle = values.size() / 2;
+    if (threads > 1) {
+        future<BigInt> left = async(launch::async, productTree,
+                                    values.subspan(0, middle), threads / 2);
+        BigInt right = productTree(values.subspan(middle), threads - threads / 2);
+        BigInt result = left.get();
+        return result *= right;
+    }
+    BigInt result = productTree(values.subspan(0, middle), 1);
+    return result *= productTree(values.subspan(middle), 1);
+}
+
+/*
+//  Multiplies a list of machine integers with a product tree.
+//    - Neighbouring factors are first packed into single words while
+//      their product fits, and each leaf is built with the scalar
+//      multiplication kernel.
+*/
+static BigInt productOfScalars(const vector<uint64_t> &factors, int setbase, unsigned threads){
+    vector<uint64_t> packed;
+    uint64_t word = 1;
+    for (unsigned int i = 0; i < factors.size(); i++) {
+        if (factors[i] != 0 && word > UINT64_MAX / factors[i]) {
+            packed.push_back(word);
+            word = 1;
+        }
+        word *= factors[i];
+    }
+    packed.push_back(word);
+    
+    const unsigned int leafsize = 16;
+    vector<BigInt> leaves;
+    for (unsigned int i = 0; i < packed.size(); i += leafsize) {
+        BigInt leaf(1, setbase);
+        for (unsigned int j = i; j < packed.size() && j < i + leafsize; j++) {
+            leaf *= packed[j];
+        }
+        leaves.push_back(leaf);
+    }
+    return productTree(leaves, threads);
+}
+
+/*
+//  Returns every prime <= n, using a sieve of Eratosthenes.
+*/
+static vector<uint64_t> primesUpTo(uint64_t n){
+    vector<uint64_t> primes;
+    if (n < 2) {
+        return primes;
+    }
+    vector<bool> composite(n + 1, false);
+    for (uint64_t i = 2; i <= n; i++) {
+        if (composite[i]) {
+            continue;
+        }
+        primes.push_back(i);
+        for (uint64_t j = i * i; j <= n; j += i) {
+            composite[j] = true;
+        }
+    }
+    return primes;
+}
+
+/*
+//  Computes the swing number n! / ((n/2)!)^2 from its prime factorisation.
+//    - The exponent of p is the number of odd terms in n/p, n/p^2, ...
+*/
+static BigInt primeSwing(uint64_t n, const vector<uint64_t> &primes, int setbase, unsigned threads){
+    vector<uint64_t> factors;
+    for (unsigned int i = 0; i < primes.size() && primes[i] <= n; i++) {
+        uint64_t p = primes[i];
+        uint64_t q = n;
+        uint64_t power = 1;
+        while (q >= p) {
+            q /= p;
+            if (q & 1) {
+                power *= p;
+            }
+        }
+        if (power > 1) {
+            factors.push_back(power);
+        }
+    }
+    return productOfScalars(factors, setbase, threads);
+}
+
+static BigInt factorialSwing(uint64_t n, const vector<uint64_t> &primes, int setbase, unsigned threads){
+    if (n < 20) {
+        BigInt result(1, setbase);
+        for (uint64_t i = 2; i <= n; i++) {
+            result *= i;
+        }
+        return result;
+    }
+    BigInt result = factorialSwing(n / 2, primes, setbase, threads);
+    result.square();
+    return result *= primeSwing(n, primes, setbase, threads);
+}
+
+/*
+//  Computes the product of all the values with a balanced product tree.
+//    - The product of no values is 1 (base 10).
+//    - threads > 1 computes independent subtrees concurrently.
+*/
+BigInt product(span<const BigInt> values, unsigned threads){
+    if (values.empty()) {
+        return BigInt(1, 10);
+    }
+    return productTree(values, max(threads, 1u));
+}
+
+/*
+//  Computes n! with the prime swing algorithm:
+//    n! = ((n/2)!)^2 * swing(n), where swing(n) is a product of prime
+//    powers multiplied together with a product tree.
+*/
+BigInt factorial(uint64_t n, int setbase, unsigned threads){
+    return factorialSwing(n, primesUpTo(n), setbase, max(threads, 1u));
+}
+
+/*
+//  Computes n choose k.
+//    - Returns 0 if k > n.
+//    - Small k (k * k <= n) divides the product (n-k+1)...n by k!, with
+//      the scalar kernel while k! fits in a word (k <= 20), so the cost
+//      follows k instead of n.
+//    - Otherwise it is built from its prime factorisation (Legendre's
+//      formula), which sieves the primes up to n.
+*/
+BigInt binomial(uint64_t n, uint64_t k, int setbase, unsigned threads){
+    if (k > n) {
+        return BigInt(0, setbase);
+    }
+    k = min(k, n - k);
+    if (k <= n / max<uint64_t>(k, 1)) {
+        vector<uint64_t> factors;
+        for (uint64_t i = 0; i < k; i++) {
+            factors.push_back(n - i);
+        }
+        BigInt falling = productOfScalars(factors, setbase, max(threads, 1u));
+        if (k <= 20) {
+            uint64_t divisor = 1;
+            for (uint64_t i = 2; i <= k; i++) {
+                divisor *= i;
+            }
+            return falling /= divisor;
+        }
+        return falling / factorial(k, setbase, threads);
+    }
+    
+    vector<uint64_t> primes = primesUpTo(n);
+    vector<uint64_t> factors;
+    for (unsigned int i = 0; i < primes.size(); i++) {
+        uint64_t p = primes[i];
+        uint64_t nq = n, kq = k, rq = n - k;
+        uint64_t power = 1;
+        while (nq >= p) {
+            nq /= p;
+            kq /= p;
+            rq /= p;
+            for (uint64_t e = nq - kq - rq; e > 0; e--) {
+                power *= p;
+            }
+        }
+        if (power > 1) {
+            factors.push_back(power);
+        }
+    }
+    return productOfScalars(factors, setbase, max(threads, 1u));
+}
+
+/*
+//  Computes the product of all primes <= n.
+*/
+BigInt primorial(uint64_t n, int setbase, unsigned threads){
+    return productOfScalars(primesUpTo(n), setbase, max(threads, 1u));
+}
+
+
+//----------------------------------------------------
+//* Montgomery arithmetic and primality testing
+//----------------------------------------------------
+
+
+/*
+//  Sets up arithmetic modulo m.
+//    - m must be positive, odd and share no factor with its base, which
+//      holds for any m that survived trial division by the primes < 37.
+*/
+MontgomeryContext::MontgomeryContext(const BigInt &m){
+    modulus = m;
+    modulus.isPositive = true;
+    while (modulus.vec.size() > 1 && modulus.vec.back() == 0) {
+        modulus.vec.pop_back();
+    }
+    base = modulus.base;
+    size = modulus.vec.size();
+    
+    // inverse = -m^-1 mod base, found by checking every digit
+    inverse = 0;
+    for (int i = 1; i < base; i++) {
+        if ((modulus.vec[0] * i) % base == base - 1) {
+            inverse = i;
+            break;
+        }
+    }
+    if (inverse == 0) {
+        cout << "Invalid Modulus Error";
+    }
+    
+    // R = base^size, so R mod m and R^2 mod m are powers of the base
+    BigInt r(base);
+    r.vec.assign(size + 1, 0);
+    r.vec[size] = 1;
+    rModN = r % modulus;
+    r.vec.assign(2 * size + 1, 0);
+    r.vec[2 * size] = 1;
+    rSquared = r % modulus;
+}
+
+/*
+//  Montgomery reduction: returns t / R mod m for t < m * R.
+//    - Each step adds the multiple of m that clears the lowest digit of
+//      t, then shifts that digit's carry up.
+*/
+BigInt MontgomeryContext::reduce(vector<long long> &t) const{
+    t.resize(2 * size + 1, 0);
+    for (int i = 0; i < size; i++) {
+        long long u = (t[i] % base) * inverse % base;
+        for (int j = 0; j < size; j++) {
+            t[i + j] += u * modulus.vec[j];
+        }
+        t[i + 1] += t[i] / base;
+    }
+    
+    BigInt result(base);
+    result.vec.assign(size + 1, 0);
+    long long carry = 0;
+    for (int i = 0; i <= size; i++) {
+        carry += t[size + i];
+        result.vec[i] = carry % base;
+        carry /= base;
+    }
+    while (result.vec.size() > 1 && result.vec.back() == 0) {
+        result.vec.pop_back();
+    }
+    if (result.compare(modulus) != -1) {
+        result -= modulus;
+    }
+    return result;
+}
+
+/*
+//  Converts a into Montgomery form, reducing it into [0, m) first.
+*/
+BigInt MontgomeryContext::toMontgomery(const BigInt &a) const{
+    if (a.base != base) {
+        BigInt converted;
+        if (!BigInt::convertBase(a, base, converted)) {
+            return BigInt(0, base);
+        }
+        return toMontgomery(converted);
+    }
+    BigInt reduced = a % modulus;
+    if (!reduced.isPositive) {
+        reduced += modulus;
+    }
+    return multiply(reduced, rSquared);
+}
+
+/*
+//  Converts a out of Montgomery form.
+*/
+BigInt MontgomeryContext::fromMontgomery(const BigInt &a) const{
+    vector<long long> t(a.vec.begin(), a.vec.end());
+    return reduce(t);
+}
+
+/*
+//  Computes a * b / R mod m, the product of two Montgomery form values.
+*/
+BigInt MontgomeryContext::multiply(const BigInt &a, const BigInt &b) const{
+    vector<long long> a_digits(a.vec.begin(), a.vec.end());
+    vector<long long> b_digits(b.vec.begin(), b.vec.end());
+    vector<long long> t(a_digits.size() + b_digits.size() - 1);
+    multiplyCoefficients(a_digits.data(), a_digits.size(),
+                         b_digits.data(), b_digits.size(), t.data());
+    return reduce(t);
+}
+
+/*
+//  Computes a * a / R mod m with the squaring kernel.
+*/
+BigInt MontgomeryContext::square(const BigInt &a) const{
+    vector<long long> digits(a.vec.begin(), a.vec.end());
+    vector<long long> t(2 * digits.size() - 1);
+    squareCoefficients(digits.data(), digits.size(), t.data());
+    return reduce(t);
+}
+
+/*
+//  Computes a + b mod m for a, b in [0, m).
+*/
+BigInt MontgomeryContext::add(const BigInt &a, const BigInt &b) const{
+    BigInt sum = a + b;
+    if (sum.compare(modulus) != -1) {
+        sum -= modulus;
+    }
+    return sum;
+}
+
+/*
+//  Computes a - b mod m for a, b in [0, m).
+*/
+BigInt MontgomeryContext::subtract(const BigInt &a, const BigInt &b) const{
+    BigInt difference = a - b;
+    if (!difference.isPositive) {
+        difference += modulus;
+    }
+    return difference;
+}
+
+/*
+//  Computes a / 2 mod m. Halving commutes with Montgomery form.
+*/
+BigInt MontgomeryContext::half(const BigInt &a) const{
+    BigInt result = a;
+    if (result.remainderScalar(2) == 1) {
+        result += modulus;
+    }
+    result.divideScalar(2, false);
+    return result;
+}
+
+/*
+//  Computes a ^ e in Montgomery form, scanning e's bits from the top.
+*/
+BigInt MontgomeryContext::pow(const BigInt &a, const BigInt &e) const{
+    vector<bool> bits;
+    BigInt n = e;
+    n.isPositive = true;
+    while (!(n.vec.size() == 1 && n.vec[0] == 0)) {
+        bits.push_back(n.divideScalar(2, false) == 1);
+    }
+    
+    BigInt result = one();
+    ProgressSteps step(max<size_t>(bits.size(), 1));
+    for (int i = bits.size() - 1; i >= 0; i--) {
+        result = square(result);
+        if (bits[i]) {
+            result = multiply(result, a);
+        }
+        step.next();
+    }
+    return result;
+}
+
+/*
+//  Returns 1 in Montgomery form (R mod m).
+*/
+BigInt MontgomeryContext::one() const{
+    return rModN;
+}
+
+const BigInt & MontgomeryContext::getModulus() const{
+    return modulus;
+}
+
+
+static const uint64_t SMALL_PRIME_LIMIT = 2048;
+
+/*
+//  Returns the primes below SMALL_PRIME_LIMIT, sieved once on first use.
+*/
+static const vector<uint64_t> & smallPrimes(){
+    static const vector<uint64_t> table = primesUpTo(SMALL_PRIME_LIMIT);
+    return table;
+}
+
+/*
+//  Trial division by every prime <= limit.
+//    - Returns the smallest such prime dividing a, or 0 if there is none.
+//    - Primes are packed into words so one short division over a's
+//      digits serves several primes at once.
+*/
+uint64_t BigInt::trialDivision(uint64_t limit) const{
+    vector<uint64_t> extra;
+    if (limit > SMALL_PRIME_LIMIT) {
+        extra = primesUpTo(limit);
+    }
+    const vector<uint64_t> &primes = limit > SMALL_PRIME_LIMIT ? extra : smallPrimes();
+    
+    unsigned int i = 0;
+    while (i < primes.size() && primes[i] <= limit) {
+        unsigned int first = i;
+        uint64_t word = 1;
+        while (i < primes.size() && primes[i] <= limit && word < UINT64_MAX / 36 / primes[i]) {
+            word *= primes[i];
+            i++;
+        }
+        if (i == first) {
+            word = primes[i++];
+        }
+        uint64_t remainder = remainderScalar(word);
+        for (unsigned int j = first; j < i; j++) {
+            if (remainder % primes[j] == 0) {
+                return primes[j];
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+//  Checks whether r is a square modulo a small modulus m.
+*/
+static bool isSquareResidue(uint64_t r, uint64_t m){
+    for (uint64_t x = 0; x < m; x++) {
+        if (x * x % m == r) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+//  Computes the Jacobi symbol (a / m) for small a and odd m > 0.
+*/
+static int jacobiSmall(uint64_t a, uint64_t m){
+    int result = 1;
+    a %= m;
+    while (a != 0) {
+        while (a % 2 == 0) {
+            a /= 2;
+            if (m % 8 == 3 || m % 8 == 5) {
+                result = -result;
+            }
+        }
+        swap(a, m);
+        if (a % 4 == 3 && m % 4 == 3) {
+            result = -result;
+        }
+        a %= m;
+    }
+    if (m == 1) {
+        return result;
+    }
+    return 0;
+}
+
+/*
+//  Miller-Rabin test to the given witness (in Montgomery form).
+//    - n - 1 = d * 2^s, with d odd.
+*/
+static bool millerRabin(const MontgomeryContext &context, const BigInt &witness,
+                        const BigInt &d, int s){
+    BigInt one = context.one();
+    BigInt minusOne = context.subtract(context.subtract(one, one), one);
+    BigInt x = context.pow(witness, d);
+    if (x == one || x == minusOne) {
+        return true;
+    }
+    for (int r = 1; r < s; r++) {
+        x = context.square(x);
+        if (x == minusOne) {
+            return true;
+        }
+        if (x == one) {
+            return false;
+        }
+    }
+    return false;
+}
+
+/*
+//  Strong Lucas test with parameters P = 1, Q = (1 - D) / 4.
+//    - n + 1 = d * 2^s, with d odd, and 'bits' holds d's bits from the top.
+//    - U and V are stepped with the doubling formulas
+//        U(2k) = U(k)V(k),  V(2k) = V(k)^2 - 2Q^k
+//      and the increment formulas
+//        U(k+1) = (U(k) + V(k)) / 2,  V(k+1) = (DU(k) + V(k)) / 2.
+*/
+static bool strongLucas(const MontgomeryContext &context, const BigInt &dMont,
+                        const BigInt &qMont, const vector<bool> &bits, int s){
+    BigInt zero = context.subtract(context.one(), context.one());
+    BigInt u = context.one();
+    BigInt v = context.one();
+    BigInt qk = qMont;
+    
+    for (int i = bits.size() - 2; i >= 0; i--) {
+        u = context.multiply(u, v);
+        v = context.subtract(context.square(v), context.add(qk, qk));
+        qk = context.square(qk);
+        if (bits[i]) {
+            BigInt nextU = context.half(context.add(u, v));
+            v = context.half(context.add(context.multiply(dMont, u), v));
+            u = nextU;
+            qk = context.multiply(qk, qMont);
+        }
+    }
+    if (u == zero || v == zero) {
+        return true;
+    }
+    for (int r = 1; r < s; r++) {
+        v = context.subtract(context.square(v), context.add(qk, qk));
+        if (v == zero) {
+            return true;
+        }
+        qk = context.square(qk);
+    }
+    return false;
+}
+
+/*
+//  Computes floor(sqrt(n)) with Newton's method, starting above the root.
+//    - Long values start from the root of their top half: with 2k low
+//      digits dropped, (isqrt(high) + 1) * base^k is above the root and
+//      already has about half its digits right, so a couple of full size
+//      Newton steps finish it. The work is dominated by those last steps.
+*/
+static const int ISQRT_SPLIT = 16;
+
+BigInt isqrt(const BigInt &n){
+    int size = n.vec.size();
+    while (size > 1 && n.vec[size - 1] == 0) {
+        size--;
+    }
+    if (!n.isPositive || (size == 1 && n.vec[0] == 0)) {
+        return BigInt(0, n.base);
+    }
+    
+    BigInt x(n.base);
+    if (size > ISQRT_SPLIT) {
+        int k = (size - 1) / 4;
+        BigInt high(n.base);
+        high.vec.assign(n.vec.begin() + 2 * k, n.vec.begin() + size);
+        BigInt root = isqrt(high) + 1;
+        vector<int> digits(k, 0);
+        digits.insert(digits.end(), root.vec.begin(), root.vec.end());
+        x.vec = move(digits);
+    }
+    else {
+        // base^ceil(size / 2) is already above the root
+        x.vec.assign((size + 1) / 2 + 1, 0);
+        x.vec.back() = 1;
+    }
+    BigInt y = (x + n / x) / 2;
+    while (y.compare(x) == -1) {
+        x = y;
+        y = (x + n / x) / 2;
+    }
+    return x;
+}
+
+/*
+//  Baillie-PSW probable prime test: trial division, a base 2 Miller-Rabin
+//  test and a strong Lucas test, all sharing one Montgomery context.
+//    - 'rounds' adds further Miller-Rabin tests to the next prime bases.
+//    - No composite is known to pass BPSW, and none exist below 2^64.
+*/
+bool BigInt::isProbablePrime(int rounds) const{
+    if (!isPositive) {
+        return false;
+    }
+    BigInt n = *this;
+    while (n.vec.size() > 1 && n.vec.back() == 0) {
+        n.vec.pop_back();
+    }
+    if (n.compare(BigInt(2, base)) == -1) {
+        return false;
+    }
+    
+    // Small factors, and small numbers, are settled by the prime table
+    uint64_t factor = n.trialDivision(SMALL_PRIME_LIMIT - 1);
+    if (factor != 0) {
+        return n.compare(BigInt((int) factor, base)) == 0;
+    }
+    if (n.compare(BigInt((int) (SMALL_PRIME_LIMIT * SMALL_PRIME_LIMIT), base)) == -1) {
+        return true;
+    }
+    
+    MontgomeryContext context(n);
+    
+    // n - 1 = d * 2^s
+    BigInt d = n - 1;
+    int s = 0;
+    while (d.remainderScalar(2) == 0) {
+        d.divideScalar(2, false);
+        s++;
+    }
+    if (!millerRabin(context, context.toMontgomery(BigInt(2, base)), d, s)) {
+        return false;
+    }
+    
+    // A square never yields Jacobi symbol -1, so rule squares out before
+    // searching for D
+    uint64_t residue = n.remainderScalar(64 * 63 * 65 * 11);
+    if (isSquareResidue(residue % 64, 64) && isSquareResidue(residue % 63, 63) &&
+        isSquareResidue(residue % 65, 65) && isSquareResidue(residue % 11, 11)) {
+        BigInt root = isqrt(n);
+        if ((root * root).compare(n) == 0) {
+            return false;
+        }
+    }
+    
+    // Selfridge's method: the first D in 5, -7, 9, -11, ... with (D/n) = -1
+    long long dValue = 5;
+    uint64_t nMod4 = n.remainderScalar(4);
+    while (true) {
+        uint64_t magnitude = dValue < 0 ? -dValue : dValue;
+        int symbol = jacobiSmall(n.remainderScalar(magnitude), magnitude);
+        if (magnitude % 4 == 3 && nMod4 == 3) {
+            symbol = -symbol;
+        }
+        if (dValue < 0 && nMod4 == 3) {
+            symbol = -symbol;
+        }
+        if (symbol == -1) {
+            break;
+        }
+        if (symbol == 0) {
+            return false;
+        }
+        dValue = dValue < 0 ? -dValue + 2 : -(dValue + 2);
+    }
+    
+    // n + 1 = d * 2^s, read into bits from the bottom
+    BigInt lucasD = n + 1;
+    int lucasS = 0;
+    while (lucasD.remainderScalar(2) == 0) {
+        lucasD.divideScalar(2, false);
+        lucasS++;
+    }
+    vector<bool> bits;
+    while (!(lucasD.vec.size() == 1 && lucasD.vec[0] == 0)) {
+        bits.push_back(lucasD.divideScalar(2, false) == 1);
+    }
+    BigInt dMont = context.toMontgomery(BigInt(0, base) + dValue);
+    BigInt qMont = context.toMontgomery(BigInt(0, base) + (1 - dValue) / 4);
+    if (!strongLucas(context, dMont, qMont, bits, lucasS)) {
+        return false;
+    }
+    
+    const vector<uint64_t> &primes = smallPrimes();
+    for (int i = 1; i <= rounds && i < (int) primes.size(); i++) {
+        if (!millerRabin(context, context.toMontgomery(BigInt((int) primes[i], base)), d, s)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+//  Returns the smallest probable prime greater than n.
+//    - Candidates are sieved by keeping n's residues modulo the small
+//      primes and stepping them, so most composites are skipped without
+//      touching n's digits again.
+*/
+BigInt nextPrime(const BigInt &n){
+    BigInt candidate = n + 1;
+    BigInt two(2, n.base);
+    BigInt limit((int) SMALL_PRIME_LIMIT, n.base);
+    if (candidate.compare(two) != 1) {
+        return two;
+    }
+    if (candidate.remainderScalar(2) == 0) {
+        candidate += 1;
+    }
+    
+    const vector<uint64_t> &primes = smallPrimes();
+    vector<uint64_t> residues(primes.size());
+    for (unsigned int i = 1; i < primes.size(); i++) {
+        residues[i] = candidate.remainderScalar(primes[i]);
+    }
+    
+    while (true) {
+        // Below the table's limit a zero residue may be the prime itself
+        bool sieved = false;
+        if (candidate.compare(limit) != -1) {
+            for (unsigned int i = 1; i < primes.size(); i++) {
+                if (residues[i] == 0) {
+                    sieved = true;
+                    break;
+                }
+            }
+        }
+        if (!sieved && candidate.isProbablePrime()) {
+            return candidate;
+        }
+        candidate += 2;
+        for (unsigned int i = 1; i < primes.size(); i++) {
+            residues[i] = (residues[i] + 2) % primes[i];
+        }
+    }
+}
+
+/*
+//  Runs isProbablePrime on independent candidates, spread over threads.
+*/
+vector<bool> isProbablePrime(span<const BigInt> candidates, int rounds, unsigned threads){
+    vector<char> results(candidates.size(), 0);
+    atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next++; i < candidates.size(); i = next++) {
+            results[i] = candidates[i].isProbablePrime(rounds);
+        }
+    };
+    
+    vector<thread> pool;
+    for (unsigned int i = 1; i < threads; i++) {
+        pool.push_back(thread(worker));
+    }
+    worker();
+    for (unsigned int i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+    return vector<bool>(results.begin(), results.end());
+}
+
+
+//----------------------------------------------------
+//* Deferred-carry accumulation
+//----------------------------------------------------
+
+
+// Limbs are carried before any of them could exceed this magnitude
+static const long long ACCUMULATOR_LIMIT = 1LL << 62;
+
+/*
+//  Creates an accumulator holding 0 in the given base.
+*/
+BigIntAccumulator::BigIntAccumulator(int setbase){
+    if(setbase < 2 || setbase > 36){
+        cout << "Invalid Base Error";
+        return;
+    }
+    base = setbase;
+}
+
+/*
+//  Carries every limb into [0, base), leaving the sign of the total in
+//  the top limb.
+*/
+void BigIntAccumulator::normalize(){
+    long long carry = 0;
+    for (unsigned int i = 0; i < limbs.size(); i++) {
+        long long value = limbs[i] + carry;
+        carry = value / base;
+        value -= carry * base;
+        if (value < 0) {
+            value += base;
+            carry--;
+        }
+        limbs[i] = value;
+    }
+    
+    // Once the carry is a single digit it is kept whole, since a negative
+    // carry never shrinks to 0 under floor division
+    while (carry >= base || carry <= -base) {
+        long long value = carry % base;
+        carry /= base;
+        if (value < 0) {
+            value += base;
+            carry--;
+        }
+        limbs.push_back(value);
+    }
+    if (carry != 0) {
+        limbs.push_back(carry);
+    }
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
+    }
+    bound = base;
+}
+
+/*
+//  Adds sign * a into the limbs.
+*/
+void BigIntAccumulator::accumulate(const BigInt &a, int sign){
+    if (base == 0) {
+        cout << "Invalid Base Error";
+        return;
+    }
+    if(base != a.base){
+        BigInt converted;
+        if (BigInt::convertBase(a, base, converted)) {
+            accumulate(converted, sign);
+        }
+        return;
+    }
+    if (bound > ACCUMULATOR_LIMIT - base) {
+        normalize();
+    }
+    if (!a.isPositive) {
+        sign = -sign;
+    }
+    if (limbs.size() < a.vec.size()) {
+        limbs.resize(a.vec.size(), 0);
+    }
+    for (unsigned int i = 0; i < a.vec.size(); i++) {
+        limbs[i] += sign * a.vec[i];
+    }
+    bound += base;
+}
+
+/*
+//  Adds sign * a * b into the limbs without carrying or building the
+//  product as a BigInt.
+*/
+void BigIntAccumulator::accumulateProduct(const BigInt &a, const BigInt &b, int sign){
+    if (base == 0) {
+        cout << "Invalid Base Error";
+        return;
+    }
+    if(base != a.base || base != b.base){
+        BigInt a_converted, b_converted;
+        if (BigInt::convertBase(a, base, a_converted) && BigInt::convertBase(b, base, b_converted)) {
+            accumulateProduct(a_converted, b_converted, sign);
+        }
+        return;
+    }
+    int a_size = a.vec.size();
+    int b_size = b.vec.size();
+    if (a_size == 0 || b_size == 0) {
+        return;
+    }
+    
+    // Each product coefficient is at most min(a_size, b_size) * (base-1)^2
+    long long growth = (long long) min(a_size, b_size) * (base - 1) * (base - 1);
+    if (bound > ACCUMULATOR_LIMIT - growth) {
+        normalize();
+    }
+    if (a.isPositive != b.isPositive) {
+        sign = -sign;
+    }
+    if ((int) limbs.size() < a_size + b_size - 1) {
+        limbs.resize(a_size + b_size - 1, 0);
+    }
+    
+    if (min(a_size, b_size) < karatsubaMultiplyThreshold.load(memory_order_relaxed)) {
+        for (int i = 0; i < a_size; i++) {
+            long long digit = sign * a.vec[i];
+            for (int j = 0; j < b_size; j++) {
+                limbs[i + j] += digit * b.vec[j];
+            }
+        }
+    }
+    else {
+        vector<long long> a_digits(a.vec.begin(), a.vec.end());
+        vector<long long> b_digits(b.vec.begin(), b.vec.end());
+        vector<long long> coefficients(a_size + b_size - 1);
+        multiplyCoefficients(a_digits.data(), a_size, b_digits.data(), b_size,
+                             coefficients.data());
+        for (int i = 0; i < a_size + b_size - 1; i++) {
+            limbs[i] += sign * coefficients[i];
+        }
+    }
+    bound += growth;
+}
+
+/*
+//  Computes acc = acc + a.
+*/
+const BigIntAccumulator & BigIntAccumulator::operator += (const BigInt &a){
+    accumulate(a, 1);
+    return *this;
+}
+
+/*
+//  Computes acc = acc - a.
+*/
+const BigIntAccumulator & BigIntAccumulator::operator -= (const BigInt &a){
+    accumulate(a, -1);
+    return *this;
+}
+
+/*
+//  Computes acc = acc + a * b.
+*/
+void BigIntAccumulator::addmul(const BigInt &a, const BigInt &b){
+    accumulateProduct(a, b, 1);
+}
+
+/*
+//  Computes acc = acc - a * b.
+*/
+void BigIntAccumulator::submul(const BigInt &a, const BigInt &b){
+    accumulateProduct(a, b, -1);
+}
+
+/*
+//  Carries the limbs and returns the sum as a BigInt.
+//    - A negative total is negated limb by limb and carried again, so the
+//      digits of its magnitude come out in [0, base).
+*/
+BigInt BigIntAccumulator::value(){
+    if (base == 0) {
+        cout << "Invalid Base Error";
+        return BigInt();
+    }
+    normalize();
+    BigInt result(0, base);
+    if (limbs.empty()) {
+        return result;
+    }
+    bool negative = limbs.back() < 0;
+    if (negative) {
+        for (unsigned int i = 0; i < limbs.size(); i++) {
+            limbs[i] = -limbs[i];
+        }
+        normalize();
+    }
+    result.vec.assign(limbs.begin(), limbs.end());
+    result.isPositive = !negative;
+    if (negative) {
+        for (unsigned int i = 0; i < limbs.size(); i++) {
+            limbs[i] = -limbs[i];
+        }
+        bound = base;
+    }
+    return result;
+}
+
+/*
+//  Resets the accumulator to 0.
+*/
+void BigIntAccumulator::clear(){
+    limbs.clear();
+    bound = 0;
+}
+
+
+//----------------------------------------------------
+//* Residue number system
+//----------------------------------------------------
+
+
+// Below this many residues per thread, element-wise work stays on one thread
+static const int RNS_PARALLEL_THRESHOLD = 4096;
+
+/*
+//  Computes a^e mod m for word-sized m.
+*/
+static uint64_t powModWord(uint64_t a, uint64_t e, uint64_t m){
+    uint64_t result = 1;
+    a %= m;
+    while (e != 0) {
+        if (e & 1) {
+            result = result * a % m;
+        }
+        a = a * a % m;
+        e >>= 1;
+    }
+    return result;
+}
+
+/*
+//  Deterministic Miller-Rabin for n < 2^32 (bases 2, 3, 5 and 7 suffice).
+*/
+static bool isPrimeWord(uint64_t n){
+    if (n < 2) {
+        return false;
+    }
+    for (uint64_t p : {2, 3, 5, 7}) {
+        if (n % p == 0) {
+            return n == p;
+        }
+    }
+    uint64_t d = n - 1;
+    int s = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        s++;
+    }
+    for (uint64_t a : {2, 3, 5, 7}) {
+        uint64_t x = powModWord(a, d, n);
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        bool composite = true;
+        for (int r = 1; r < s && composite; r++) {
+            x = x * x % n;
+            if (x == n - 1) {
+                composite = false;
+            }
+        }
+        if (composite) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+//  Creates a basis of the 'count' largest primes below 2^31.
+//    - inverses[i][j] = primes[j]^-1 mod primes[i] for j < i, which is
+//      all Garner's algorithm needs.
+*/
+RNSBasis::RNSBasis(int count, int setbase, unsigned setthreads){
+    base = setbase;
+    threads = max(setthreads, 1u);
+    for (uint64_t candidate = (1ULL << 31) - 1; (int) primes.size() < count; candidate -= 2) {
+        if (isPrimeWord(candidate)) {
+            primes.push_back(candidate);
+        }
+    }
+    
+    inverses.resize(count);
+    for (int i = 0; i < count; i++) {
+        inverses[i].resize(i);
+        for (int j = 0; j < i; j++) {
+            inverses[i][j] = powModWord(primes[j], primes[i] - 2, primes[i]);
+        }
+    }
+    
+    vector<BigInt> factors;
+    for (int i = 0; i < count; i++) {
+        factors.push_back(BigInt(0, base) + primes[i]);
+    }
+    modulus = product(factors, threads);
+    halfModulus = modulus / 2;
+}
+
+int RNSBasis::size() const{
+    return primes.size();
+}
+
+const vector<uint32_t> & RNSBasis::getPrimes() const{
+    return primes;
+}
+
+/*
+//  Converts a BigInt to residues.
+//    - All residues are built in one pass over a's digits, with the
+//      primes in the inner loop.
+//    - Must satisfy |a| < M / 2 to convert back unchanged.
+*/
+RNSInteger RNSBasis::toRNS(const BigInt &a) const{
+    if(base != a.base){
+        BigInt converted;
+        if (!BigInt::convertBase(a, base, converted)) {
+            return RNSInteger(*this);
+        }
+        return toRNS(converted);
+    }
+    RNSInteger result(*this);
+    int count = primes.size();
+    vector<uint64_t> remainders(count, 0);
+    for (int i = a.vec.size() - 1; i >= 0; i--) {
+        uint64_t digit = a.vec[i];
+        for (int j = 0; j < count; j++) {
+            remainders[j] = (remainders[j] * base + digit) % primes[j];
+        }
+    }
+    for (int j = 0; j < count; j++) {
+        if (!a.isPositive && remainders[j] != 0) {
+            remainders[j] = primes[j] - remainders[j];
+        }
+        result.residues[j] = remainders[j];
+    }
+    return result;
+}
+
+/*
+//  Converts residues back to a BigInt with Garner's algorithm.
+//    - Garner finds mixed radix digits v with
+//        x = v0 + v1 p0 + v2 p0 p1 + ...
+//      using word arithmetic only, and x is then rebuilt with the scalar
+//      kernels. Values above M / 2 are read as negative.
+*/
+BigInt RNSBasis::toBigInt(const RNSInteger &a) const{
+    if(a.basis != this){
+        cout << "Invalid Basis Error";
+        return BigInt(0, base);
+    }
+    int count = primes.size();
+    vector<uint64_t> digits(count);
+    for (int i = 0; i < count; i++) {
+        uint64_t p = primes[i];
+        uint64_t t = a.residues[i];
+        for (int j = 0; j < i; j++) {
+            t = (t + p - digits[j] % p) % p * inverses[i][j] % p;
+        }
+        digits[i] = t;
+    }
+    
+    BigInt result(0, base);
+    for (int i = count - 1; i >= 0; i--) {
+        result *= primes[i];
+        result += digits[i];
+    }
+    if (result.compare(halfModulus) == 1) {
+        result -= modulus;
+    }
+    return result;
+}
+
+/*
+//  Creates the RNS value 0.
+*/
+RNSInteger::RNSInteger(const RNSBasis &b){
+    basis = &b;
+    residues.assign(b.primes.size(), 0);
+}
+
+const vector<uint32_t> & RNSInteger::getResidues() const{
+    return residues;
+}
+
+/*
+//  Calls f(first, last) over the residue range, split into one
+//  contiguous block per thread when the basis is large enough.
+*/
+template <typename F>
+void RNSInteger::forEachRange(F f){
+    int count = residues.size();
+    int threads = basis->threads;
+    if (threads <= 1 || count < threads * RNS_PARALLEL_THRESHOLD) {
+        f(0, count);
+        return;
+    }
+    vector<thread> pool;
+    int block = (count + threads - 1) / threads;
+    for (int first = block; first < count; first += block) {
+        pool.push_back(thread(f, first, min(count, first + block)));
+    }
+    f(0, block);
+    for (unsigned int i = 0; i < pool.size(); i++) {
+        pool[i].join();
+    }
+}
+
+/*
+//  Computes a = a + b, residue by residue.
+*/
+const RNSInteger & RNSInteger::operator += (const RNSInteger &b){
+    if (basis != b.basis) {
+        cout << "Invalid Basis Error";
+        return *this;
+    }
+    const uint32_t *p = basis->primes.data();
+    const uint32_t *y = b.residues.data();
+    uint32_t *x = residues.data();
+    forEachRange([=](int first, int last) {
+        for (int i = first; i < last; i++) {
+            uint32_t sum = x[i] + y[i];
+            x[i] = sum >= p[i] ? sum - p[i] : sum;
+        }
+    });
+    return *this;
+}
+
+/*
+//  Computes a = a - b, residue by residue.
+*/
+const RNSInteger & RNSInteger::operator -= (const RNSInteger &b){
+    if (basis != b.basis) {
+        cout << "Invalid Basis Error";
+        return *this;
+    }
+    const uint32_t *p = basis->primes.data();
+    const uint32_t *y = b.residues.data();
+    uint32_t *x = residues.data();
+    forEachRange([=](int first, int last) {
+        for (int i = first; i < last; i++) {
+            uint32_t difference = x[i] - y[i];
+            x[i] = x[i] < y[i] ? difference + p[i] : difference;
+        }
+    });
+    return *this;
+}
+
+/*
+//  Computes a = a * b, residue by residue.
+*/
+const RNSInteger & RNSInteger::operator *= (const RNSInteger &b){
+    if (basis != b.basis) {
+        cout << "Invalid Basis Error";
+        return *this;
+    }
+    const uint32_t *p = basis->primes.data();
+    const uint32_t *y = b.residues.data();
+    uint32_t *x = residues.data();
+    forEachRange([=](int first, int last) {
+        for (int i = first; i < last; i++) {
+            x[i] = (uint64_t) x[i] * y[i] % p[i];
+        }
+    });
+    return *this;
+}
+
+//Calls the += function above to compute an RNSInteger whose value is a + b
+RNSInteger operator + (const RNSInteger &a, const RNSInteger &b){
+
+    RNSInteger temp = a;
+    return temp += b;
+}
+
+//Calls the -= function above to compute an RNSInteger whose value is a - b
+RNSInteger operator - (const RNSInteger &a, const RNSInteger &b){
+
+    RNSInteger temp = a;
+    return temp -= b;
+}
+
+//Calls the *= function above to compute an RNSInteger whose value is a * b
+RNSInteger operator * (const RNSInteger &a, const RNSInteger &b){
+
+    RNSInteger temp = a;
+    return temp *= b;
+}
+
+
+/*
+//  Asynchronous operations.
+//    - Each runs a copy of its operands on the executor (or its own
+//      thread), with the caller's options installed for the checkpoints
+//      above. Copies are cheap since the digits are shared.
+//    - Cancellation surfaces as OperationCancelled from the future's get().
+*/
+CancellationToken::CancellationToken(){
+    flag = make_shared<atomic<bool>>(false);
+}
+
+void CancellationToken::cancel() const{
+    flag->store(true, memory_order_relaxed);
+}
+
+bool CancellationToken::cancelled() const{
+    return flag->load(memory_order_relaxed);
+}
+
+OperationCancelled::OperationCancelled() : runtime_error("BigInt operation cancelled"){
+}
+
+template <typename R>
+static future<R> runAsync(function<R()> job, AsyncOptions options){
+    auto body = [job, options]() {
+        ProgressState state = {&options, 0, 1, 0};
+        ProgressState *outer = activeProgress;
+        activeProgress = &state;
+        try {
+            checkpoint(0, 1);
+            R result = job();
+            activeProgress = outer;
+            if (options.progress) {
+                options.progress(1);
+            }
+            return result;
+        }
+        catch (...) {
+            activeProgress = outer;
+            throw;
+        }
+    };
+    if (!options.executor) {
+        return async(launch::async, body);
+    }
+    auto task = make_shared<packaged_task<R()>>(body);
+    future<R> result = task->get_future();
+    options.executor([task]() { (*task)(); });
+    return result;
+}
+
+//Runs the *= function above asynchronously to compute a * b
+future<BigInt> multiplyAsync(const BigInt &a, const BigInt &b, AsyncOptions options){
+
+    return runAsync<BigInt>([a, b]() {
+        BigInt temp = a;
+        return temp *= b;
+    }, options);
+}
+
+//Runs the exponentiation function above asynchronously to compute a ^ b
+future<BigInt> powAsync(const BigInt &a, const BigInt &b, AsyncOptions options){
+
+    return runAsync<BigInt>([a, b]() {
+        BigInt temp = a;
+        return temp.exponentiation(b);
+    }, options);
+}
+
+//Runs the modulusExp function above asynchronously to compute (a ^ b) % m
+future<BigInt> modPowAsync(const BigInt &a, const BigInt &b, const BigInt &m, AsyncOptions options){
+
+    return runAsync<BigInt>([a, b, m]() {
+        BigInt temp = a;
+        return temp.modulusExp(b, m);
+    }, options);
+}
+
+//Runs divisionMain asynchronously, giving the pair (a / b, a % b)
+future<pair<BigInt, BigInt>> divisionAsync(const BigInt &a, const BigInt &b, AsyncOptions options){
+
+    return runAsync<pair<BigInt, BigInt>>([a, b]() {
+        BigInt divisor = b;
+        if (a.base != b.base && !BigInt::convertBase(b, a.base, divisor)) {
+            return make_pair(a, a);
+        }
+        if (divisor.vec.size() == 1 && divisor.vec[0] == 0) {
+            cout << "Dividing by Zero Error";
+            return make_pair(a, a);
+        }
+        BigInt temp = a;
+        BigInt quotient(a.base);
+        BigInt remainder(a.base);
+        temp.divisionMain(divisor, quotient, remainder);
+        if (remainder.vec.size() == 1 && remainder.vec[0] == 0) {
+            remainder.isPositive = true;
+        }
+        return make_pair(quotient, remainder);
+    }, options);
+}
+
+
+
+/*
+//  Threshold tuning.
+//    - The crossovers used above (karatsubaMultiplyThreshold and friends)
+//      start at their compiled defaults and can be replaced at run time.
+//    - At startup a tuning profile is loaded only if the BIGINT_TUNING
+//      environment variable names one; any other profile has to be
+//      loaded explicitly with loadThresholds. Without one, or if the
+//      file is missing, the defaults are kept.
+//    - A profile is plain text, one "name value" pair per line, with '#'
+//      starting a comment line.
+*/
+static const int MIN_KARATSUBA_THRESHOLD = 8;
+static const int MIN_RADIX_CONVERSION_LEAF = 2;
+
+BigIntThresholds getThresholds(){
+    BigIntThresholds thresholds;
+    thresholds.karatsubaMultiply = karatsubaMultiplyThreshold.load(memory_order_relaxed);
+    thresholds.karatsubaSquare = karatsubaSquareThreshold.load(memory_order_relaxed);
+    thresholds.radixConversionLeaf = radixConversionLeaf.load(memory_order_relaxed);
+    return thresholds;
+}
+
+/*
+//  Replaces the thresholds in use. Values below the smallest the
+//  algorithms support are raised to it.
+*/
+void setThresholds(const BigIntThresholds &thresholds){
+    karatsubaMultiplyThreshold.store(max(thresholds.karatsubaMultiply, MIN_KARATSUBA_THRESHOLD),
+                                     memory_order_relaxed);
+    karatsubaSquareThreshold.store(max(thresholds.karatsubaSquare, MIN_KARATSUBA_THRESHOLD),
+                                   memory_order_relaxed);
+    radixConversionLeaf.store(max(thresholds.radixConversionLeaf, MIN_RADIX_CONVERSION_LEAF),
+                              memory_order_relaxed);
+}
+
+/*
+//  Loads a tuning profile and applies it.
+//    Returns false if the file cannot be read. Unknown names are skipped,
+//    and names that are not given keep their current value.
+*/
+bool loadThresholds(const string &path){
+    ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    BigIntThresholds thresholds = getThresholds();
+    string line;
+    while (getline(in, line)) {
+        istringstream fields(line);
+        string name;
+        int value;
+        if (!(fields >> name >> value) || name[0] == '#') {
+            continue;
+        }
+        if (name == "karatsuba_multiply") {
+            thresholds.karatsubaMultiply = value;
+        }
+        else if (name == "karatsuba_square") {
+            thresholds.karatsubaSquare = value;
+        }
+        else if (name == "radix_conversion_leaf") {
+            thresholds.radixConversionLeaf = value;
+        }
+    }
+    setThresholds(thresholds);
+    return true;
+}
+
+/*
+//  Writes the thresholds in use as a tuning profile.
+//    Returns false if the file cannot be written.
+*/
+bool saveThresholds(const string &path){
+    ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    BigIntThresholds thresholds = getThresholds();
+    out << "# BigInt tuning profile" << endl;
+    out << "karatsuba_multiply " << thresholds.karatsubaMultiply << endl;
+    out << "karatsuba_square " << thresholds.karatsubaSquare << endl;
+    out << "radix_conversion_leaf " << thresholds.radixConversionLeaf << endl;
+    return (bool) out;
+}
+
+static bool startupProfile = getenv("BIGINT_TUNING") && loadThresholds(getenv("BIGINT_TUNING"));
+
+/*
+//  Seconds per call of f: the best of a few runs, each long enough for
+//  the clock to be accurate.
+*/
+template <typename F>
+static double timeCall(F f){
+    double best = 1e30;
+    for (int run = 0; run < 5; run++) {
+        int calls = 0;
+        auto start = chrono::steady_clock::now();
+        double elapsed = 0;
+        do {
+            f();
+            calls++;
+            elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        } while (elapsed < 0.01);
+        best = min(best, elapsed / calls);
+    }
+    return best;
+}
+
+/*
+//  Smallest size n from 'sizes' at which one Karatsuba step (with
+//  schoolbook below it) beats schoolbook at n, and keeps beating it for
+//  the next two sizes. setThreshold switches the kernel between the two.
+*/
+template <typename F, typename S>
+static int findCrossover(const vector<int> &sizes, F run, S setThreshold){
+    int wins = 0;
+    for (unsigned int i = 0; i < sizes.size(); i++) {
+        int n = sizes[i];
+        setThreshold(n + 1);
+        double schoolbook = timeCall([&]() { run(n); });
+        setThreshold(n);
+        double karatsuba = timeCall([&]() { run(n); });
+        wins = karatsuba < schoolbook ? wins + 1 : 0;
+        if (wins == 3) {
+            return sizes[i - 2];
+        }
+    }
+    return sizes.back();
+}
+
+/*
+//  Measures the crossover points on this machine, applies them and
+//  returns them. Save them with saveThresholds to reuse them at startup.
+//    - The Karatsuba thresholds compare one Karatsuba step against
+//      schoolbook on random operands of growing size.
+//    - The radix conversion leaf is the fastest of a few candidates for
+//      a 4000 digit conversion from base 10 to base 16.
+//    - The thresholds are changed while measuring, so nothing else
+//      should be using BigInt meanwhile.
+*/
+BigIntThresholds tuneThresholds(){
+    vector<int> sizes;
+    for (int n = MIN_KARATSUBA_THRESHOLD; n <= 512; n += max(2, n / 8)) {
+        sizes.push_back(n);
+    }
+    mt19937 generator(1);
+    vector<long long> a(512), b(512), out(1023);
+    for (int i = 0; i < 512; i++) {
+        a[i] = generator() % 10;
+        b[i] = generator() % 10;
+    }
+    
+    BigIntThresholds tuned = getThresholds();
+    tuned.karatsubaMultiply = findCrossover(sizes,
+        [&](int n) { multiplyCoefficients(a.data(), n, b.data(), n, out.data()); },
+        [](int t) { karatsubaMultiplyThreshold.store(t, memory_order_relaxed); });
+    tuned.karatsubaSquare = findCrossover(sizes,
+        [&](int n) { squareCoefficients(a.data(), n, out.data()); },
+        [](int t) { karatsubaSquareThreshold.store(t, memory_order_relaxed); });
+    setThresholds(tuned);
+    
+    string text(4000, '0');
+    for (unsigned int i = 0; i < text.size(); i++) {
+        text[i] += generator() % 10;
+    }
+    BigInt value(text, 10);
+    double best = 1e30;
+    for (int leaf : {4, 8, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512}) {
+        radixConversionLeaf.store(leaf, memory_order_relaxed);
+        double seconds = timeCall([&]() { value.toBase(16); });
+        if (seconds < best) {
+            best = seconds;
+            tuned.radixConversionLeaf = leaf;
+        }
+    }
+    setThresholds(tuned);
+    return tuned;
+}
+
+
+/*
+//  Binary splitting.
+//    - binarySplit sums a series whose terms are ratios of products, as
+//      exact integers P, Q, B, T (see SeriesSplit in bigint.h). The range
+//      is halved recursively and joined with
+//          P = P1 P2,  Q = Q1 Q2,  B = B1 B2,  T = B2 Q2 T1 + B1 P1 T2,
+//      so the big multiplications are balanced, like the product tree.
+//      Without b the B factors are all 1 and are skipped.
+//    - With threads > 1 the two halves run concurrently, so p, q, a and b
+//      must be safe to call from several threads.
+//    - A constant then costs one big division, T / (B Q), at the end.
+//      For example log(2) = sum over k >= 1 of 1 / (k 2^k) is p = 1,
+//      q = 2, a = 1, b = k.
+//    - The callbacks are only called for k in [first, last). setbase is
+//      the base of the 1s that stand in for a missing b and of the
+//      identity P = Q = B = 1, T = 0 returned for an empty range.
+*/
+SeriesSplit binarySplit(uint64_t first, uint64_t last, const function<BigInt(uint64_t)> &p,
+                        const function<BigInt(uint64_t)> &q, const function<BigInt(uint64_t)> &a,
+                        const function<BigInt(uint64_t)> &b, int setbase, unsigned threads){
+    SeriesSplit result;
+    if (first >= last) {
+        result.P = BigInt(1, setbase);
+        result.Q = result.P;
+        result.B = result.P;
+        result.T = BigInt(0, setbase);
+        return result;
+    }
+    if (last - first == 1) {
+        result.P = p(first);
+        result.Q = q(first);
+        result.B = b ? b(first) : BigInt(1, setbase);
+        result.T = a(first) * result.P;
+        return result;
+    }
+    uint64_t middle = first + (last - first) / 2;
+    SeriesSplit left;
+    SeriesSplit right;
+    if (threads > 1) {
+        future<SeriesSplit> pending = async(launch::async, [&]() {
+            return binarySplit(first, middle, p, q, a, b, setbase, threads / 2);
+        });
+        right = binarySplit(middle, last, p, q, a, b, setbase, threads - threads / 2);
+        left = pending.get();
+    }
+    else {
+        left = binarySplit(first, middle, p, q, a, b, setbase, 1);
+        right = binarySplit(middle, last, p, q, a, b, setbase, 1);
+    }
+    result.P = left.P * right.P;
+    result.Q = left.Q * right.Q;
+    if (b) {
+        result.B = left.B * right.B;
+        result.T = right.B * right.Q * left.T + left.B * left.P * right.T;
+    }
+    else {
+        result.B = left.B;
+        result.T = left.T * right.Q + left.P * right.T;
+    }
+    return result;
+}
+
+/*
+//  Extra digits carried through the final division and dropped after it,
+//  so that rounding in the square root and the division does not reach
+//  the digits that are returned.
+*/
+static const int SERIES_GUARD_DIGITS = 4;
+
+/*
+//  Returns floor(pi * base^digits): pi's first digits + 1 digits, with
+//  the point after the first.
+//    - Chudnovsky's series, 1 / pi = 12 sum over k of
+//      (-1)^k (6k)! (13591409 + 545140134 k) / ((3k)! (k!)^3 640320^(3k + 3/2)),
+//      which gains about 14 decimal digits per term.
+//    - pi = 426880 sqrt(10005) Q / T, with the square root taken once at
+//      full precision with isqrt.
+*/
+BigInt piDigits(uint64_t digits, int setbase, unsigned threads){
+    if(setbase < 2 || setbase > 36){
+        cout << "Invalid Base Error";
+        return BigInt();
+    }
+    uint64_t terms = (uint64_t) ((digits + SERIES_GUARD_DIGITS) * log((double) setbase)
+                                 / log(151931373056000.0)) + 2;
+    SeriesSplit sum = binarySplit(0, terms,
+        [setbase](uint64_t k) {
+            if (k == 0) {
+                return BigInt(1, setbase);
+            }
+            // -(6k - 5)(2k - 1)(6k - 1)
+            BigInt term(6 * k - 5, setbase);
+            term *= 2 * k - 1;
+            term *= 6 * k - 1;
+            return term *= -1;
+        },
+        [setbase](uint64_t k) {
+            if (k == 0) {
+                return BigInt(1, setbase);
+            }
+            // k^3 640320^3 / 24
+            BigInt term(k, setbase);
+            term *= k;
+            term *= k;
+            return term *= (uint64_t) 10939058860032000ULL;
+        },
+        [setbase](uint64_t k) {
+            BigInt term(k, setbase);
+            term *= 545140134;
+            return term += 13591409;
+        },
+        nullptr, setbase, threads);
+    
+    string scale(2 * (digits + SERIES_GUARD_DIGITS) + 1, '0');
+    scale[0] = '1';
+    BigInt root = isqrt(BigInt(scale, setbase) * 10005);
+    BigInt result = root * 426880 * sum.Q / sum.T;
+    uint64_t guard = 1;
+    for (int i = 0; i < SERIES_GUARD_DIGITS; i++) {
+        guard *= setbase;
+    }
+    return result /= guard;
+}
+
+/*
+//  Returns floor(e * base^digits).
+//    - e = sum over k of 1 / k!, summed until k! passes base^digits.
+*/
+BigInt eDigits(uint64_t digits, int setbase, unsigned threads){
+    if(setbase < 2 || setbase > 36){
+        cout << "Invalid Base Error";
+        return BigInt();
+    }
+    double target = (digits + SERIES_GUARD_DIGITS) * log((double) setbase);
+    double logfactorial = 0;
+    uint64_t terms = 2;
+    while (logfactorial <= target) {
+        terms++;
+        logfactorial += log((double) terms);
+    }
+    SeriesSplit sum = binarySplit(0, terms,
+        [setbase](uint64_t) { return BigInt(1, setbase); },
+        [setbase](uint64_t k) { return BigInt(k == 0 ? 1 : k, setbase); },
+        [setbase](uint64_t) { return BigInt(1, setbase); },
+        nullptr, setbase, threads);
+    
+    string scale(digits + SERIES_GUARD_DIGITS + 1, '0');
+    scale[0] = '1';
+    BigInt result = sum.T * BigInt(scale, setbase) / sum.Q;
+    uint64_t guard = 1;
+    for (int i = 0; i < SERIES_GUARD_DIGITS; i++) {
+        guard *= setbase;
+    }
+    return result /= guard;
+}
@@ -6,20 +6,109 @@ Author: Max Albright
 #include <iostream>
 #include <string>
 #include <vector>
+#include <span>
+#include <cstdint>
+#include <type_traits>
+#include <atomic>
+#include <compare>
+#include <functional>
+#include <cmath>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <utility>
 using namespace std;
 
 
+/*
+//  Reference counted, copy-on-write storage for a BigInt's digits.
+//  Copies share one block in O(1); the first mutation through a shared
+//  buffer gives it a private copy (or a fresh block, for operations that
+//  overwrite everything). Const access never copies, so any number of
+//  threads can read one shared value.
+*/
+class DigitBuffer {
+  public:
+    DigitBuffer();
+    DigitBuffer(const DigitBuffer &b);
+    ~DigitBuffer();
+    DigitBuffer & operator = (const DigitBuffer &b);
+    DigitBuffer & operator = (vector<int> &&digits);
+    DigitBuffer & operator = (const vector<int> &digits);
+    bool operator == (const DigitBuffer &b) const;
+
+    size_t size() const { return block ? block->digits.size() : 0; }
+    bool empty() const { return size() == 0; }
+    const int & operator [] (size_t i) const { return block->digits[i]; }
+    int & operator [] (size_t i) { return mutate()[i]; }
+    const int & back() const { return block->digits.back(); }
+    int & back() { return mutate().back(); }
+    const int * begin() const { return block ? block->digits.data() : nullptr; }
+    const int * end() const { return begin() + size(); }
+    int * begin() { return mutate().data(); }
+    int * end() { return begin() + size(); }
+    const int * data() const { return begin(); }
+    int * data() { return begin(); }
+
+    void push_back(int digit) { mutate().push_back(digit); }
+    void pop_back() { mutate().pop_back(); }
+    void insert(size_t index, int digit);
+    void assign(size_t count, int digit) { overwrite().assign(count, digit); }
+    template <typename It, typename enable_if<!is_integral<It>::value, int>::type = 0>
+    void assign(It first, It last) { overwrite().assign(first, last); }
+
+  private:
+    struct Block {
+        atomic<int> references;
+        vector<int> digits;
+    };
+    Block *block;
+    vector<int> & mutate() {
+        if (block && block->references.load(memory_order_acquire) == 1) {
+            return block->digits;
+        }
+        return detach();
+    }
+    vector<int> & detach();
+    vector<int> & overwrite();
+    void release();
+};
+
+
+struct AsyncOptions;
+
+/*
+//  Machine integers accepted as operands: the built-in integral types,
+//  plus the 128 bit ones, which strict modes don't count as integral.
+*/
+template <typename T>
+constexpr bool isMachineInteger = is_integral<T>::value || is_same<T, __int128>::value ||
+                                  is_same<T, unsigned __int128>::value;
+
 class BigInt {
   public:
   	BigInt();
-  	BigInt(int setbase);
+  	explicit BigInt(int setbase);
   	BigInt(int input, int setbase);
-  	BigInt(const string &s, int setbase);
+  	BigInt(__int128 input, int setbase);
+  	BigInt(unsigned __int128 input, int setbase);
+  	BigInt(double input, int setbase);
+  	BigInt(long double input, int setbase);
+  	BigInt(const string &s, int setbase, unsigned threads = 1);
   	BigInt(const BigInt &b);
   	~BigInt();
-  	string to_string();
+  	string to_string(unsigned threads = 1) const;
   	int to_int() const;
+  	int64_t to_int64() const;
+  	uint64_t to_uint64() const;
+  	__int128 to_int128() const;
+  	unsigned __int128 to_uint128() const;
+  	double to_double() const;
+  	long double to_long_double() const;
+  	BigInt toBase(int newBase, unsigned threads = 1) const;
+  	int getBase() const;
   	int compare(const BigInt &b) const;
+  	size_t hash() const;
 
 
   	const BigInt & operator = (const BigInt &b);
@@ -29,14 +118,298 @@ class BigInt {
   	const BigInt & operator /= (const BigInt &b);
   	const BigInt & operator %= (const BigInt &b);
   	void divisionMain(const BigInt &b, BigInt &quotient, BigInt &remainder);
+  	const BigInt & square();
   	const BigInt & exponentiation(const BigInt &b);
   	const BigInt & modulusExp(const BigInt &b, const BigInt &m);
+  	uint64_t trialDivision(uint64_t limit = 2048) const;
+  	bool isProbablePrime(int rounds = 0) const;
+
+  	// Machine-integer operands run single-pass kernels instead of
+  	// building a temporary BigInt for the rhs. The kernels take 64 bit
+  	// magnitudes, so wider types use the overloads below.
+  	template <typename T, typename enable_if<is_integral<T>::value && sizeof(T) <= 8, int>::type = 0>
+  	const BigInt & operator += (T b) { return addScalar(scalarMagnitude(b), scalarNegative(b)); }
+  	template <typename T, typename enable_if<is_integral<T>::value && sizeof(T) <= 8, int>::type = 0>
+  	const BigInt & operator -= (T b) { return addScalar(scalarMagnitude(b), !scalarNegative(b)); }
+  	template <typename T, typename enable_if<is_integral<T>::value && sizeof(T) <= 8, int>::type = 0>
+  	const BigInt & operator *= (T b) { return multiplyScalar(scalarMagnitude(b), scalarNegative(b)); }
+  	template <typename T, typename enable_if<is_integral<T>::value && sizeof(T) <= 8, int>::type = 0>
+  	const BigInt & operator /= (T b) { divideScalar(scalarMagnitude(b), scalarNegative(b)); return *this; }
+  	template <typename T, typename enable_if<is_integral<T>::value && sizeof(T) <= 8, int>::type = 0>
+  	const BigInt & operator %= (T b) { return modulusScalar(scalarMagnitude(b)); }
+  	template <typename T, typename enable_if<is_integral<T>::value && sizeof(T) <= 8, int>::type = 0>
+  	int compare(T b) const { return compareScalar(scalarMagnitude(b), scalarNegative(b)); }
+  	template <typename T, typename enable_if<isMachineInteger<T>, int>::type = 0>
+  	const BigInt & exponentiation(T b) { return exponentiation(BigInt(b, base)); }
+  	template <typename T, typename enable_if<isMachineInteger<T>, int>::type = 0>
+  	const BigInt & modulusExp(T b, const BigInt &m) { return modulusExp(BigInt(b, base), m); }
+
+  	// 128 bit operands go through a BigInt in this value's base
+  	const BigInt & operator += (__int128 b) { return *this += BigInt(b, base); }
+  	const BigInt & operator += (unsigned __int128 b) { return *this += BigInt(b, base); }
+  	const BigInt & operator -= (__int128 b) { return *this -= BigInt(b, base); }
+  	const BigInt & operator -= (unsigned __int128 b) { return *this -= BigInt(b, base); }
+  	const BigInt & operator *= (__int128 b) { return *this *= BigInt(b, base); }
+  	const BigInt & operator *= (unsigned __int128 b) { return *this *= BigInt(b, base); }
+  	const BigInt & operator /= (__int128 b) { return *this /= BigInt(b, base); }
+  	const BigInt & operator /= (unsigned __int128 b) { return *this /= BigInt(b, base); }
+  	const BigInt & operator %= (__int128 b) { return *this %= BigInt(b, base); }
+  	const BigInt & operator %= (unsigned __int128 b) { return *this %= BigInt(b, base); }
+  	int compare(__int128 b) const { return compare(BigInt(b, base)); }
+  	int compare(unsigned __int128 b) const { return compare(BigInt(b, base)); }
+
+  	// Other machine integer types convert straight from their value
+  	template <typename T, typename enable_if<is_integral<T>::value && sizeof(T) <= 8, int>::type = 0>
+  	BigInt(T input, int setbase) { assignInteger(scalarMagnitude(input), scalarNegative(input), setbase); }
+
+  	// True if the value is representable in T without saturating
+  	// (integers) or overflowing to infinity (floating point)
+  	template <typename T>
+  	bool fitsIn() const {
+  	    if constexpr (is_floating_point<T>::value) {
+  	        if constexpr (is_same<T, long double>::value) {
+  	            return isfinite(to_long_double());
+  	        }
+  	        return isfinite((T) to_double());
+  	    }
+  	    else {
+  	        unsigned __int128 m;
+  	        return magnitude128(m) && m <= magnitudeLimit<T>(!isPositive);
+  	    }
+  	}
+
+
+  private:
+    // A constructor given an invalid base leaves base 0 and no digits,
+    // which every operator rejects instead of reading as a value
+    int base = 0;
+    bool isPositive = true;
+    DigitBuffer vec;
+
+    template <typename T>
+    static uint64_t scalarMagnitude(T b) {
+        if (is_signed<T>::value && b < 0) {
+            return 0 - (uint64_t) b;
+        }
+        return (uint64_t) b;
+    }
+    template <typename T>
+    static bool scalarNegative(T b) {
+        return is_signed<T>::value && b < 0;
+    }
+    // Largest magnitude T holds with the given sign. Written without
+    // numeric_limits so that it also covers __int128 in strict modes.
+    template <typename T>
+    static unsigned __int128 magnitudeLimit(bool negative) {
+        unsigned __int128 top = (unsigned __int128) 1 << (sizeof(T) * 8 - 1);
+        if (T(-1) < T(0)) {
+            return negative ? top : top - 1;
+        }
+        return negative ? 0 : top + (top - 1);
+    }
+    template <typename T>
+    T saturated() const {
+        unsigned __int128 m;
+        magnitude128(m);
+        unsigned __int128 limit = magnitudeLimit<T>(!isPositive);
+        if (m > limit) {
+            m = limit;
+        }
+        return isPositive ? (T) m : (T) (0 - m);
+    }
+    void assignInteger(unsigned __int128 m, bool negative, int setbase);
+    void assignFloating(long double input, int setbase);
+    bool magnitude128(unsigned __int128 &m) const;
+    unsigned __int128 leadingBits(int maxBits, int &shift) const;
+    const BigInt & addScalar(uint64_t m, bool negative);
+    const BigInt & multiplyScalar(uint64_t m, bool negative);
+    uint64_t divideScalar(uint64_t m, bool negative);
+    const BigInt & modulusScalar(uint64_t m);
+    uint64_t remainderScalar(uint64_t m) const;
+    int compareMagnitude(const int *digits, int count) const;
+    int compareScalar(uint64_t m, bool negative) const;
+    static bool convertBase(const BigInt &b, int newBase, BigInt &converted);
+    int normalizedSize() const;
+
+    friend class MontgomeryContext;
+    friend class BigIntAccumulator;
+    friend class RNSBasis;
+    friend BigInt isqrt(const BigInt &n);
+    friend BigInt nextPrime(const BigInt &n);
+    friend bool operator == (const BigInt &a, const BigInt &b);
+    friend future<pair<BigInt, BigInt>> divisionAsync(const BigInt &a, const BigInt &b,
+                                                      AsyncOptions options);
+};
+
+/*
+//  Precomputed state for arithmetic modulo a fixed odd modulus that
+//  shares no factor with its base. Values are kept in Montgomery form
+//  (a * R mod m, with R = base^digits), so products are reduced digit
+//  by digit without any long division.
+*/
+class MontgomeryContext {
+  public:
+    MontgomeryContext(const BigInt &modulus);
+    BigInt toMontgomery(const BigInt &a) const;
+    BigInt fromMontgomery(const BigInt &a) const;
+    BigInt multiply(const BigInt &a, const BigInt &b) const;
+    BigInt square(const BigInt &a) const;
+    BigInt add(const BigInt &a, const BigInt &b) const;
+    BigInt subtract(const BigInt &a, const BigInt &b) const;
+    BigInt half(const BigInt &a) const;
+    BigInt pow(const BigInt &a, const BigInt &e) const;
+    BigInt one() const;
+    const BigInt & getModulus() const;
+
+  private:
+    BigInt modulus;
+    int base;
+    int size;
+    int inverse;
+    BigInt rSquared;
+    BigInt rModN;
+    BigInt reduce(vector<long long> &t) const;
+};
+
+/*
+//  Running sum of BigInts and products of BigInts with deferred carries.
+//  Digits are kept as wide signed limbs and only carried when the sum
+//  is read (or when a limb could overflow), so summing N products costs
+//  one carry pass instead of N.
+*/
+class BigIntAccumulator {
+  public:
+    BigIntAccumulator(int setbase = 10);
+    const BigIntAccumulator & operator += (const BigInt &a);
+    const BigIntAccumulator & operator -= (const BigInt &a);
+    void addmul(const BigInt &a, const BigInt &b);
+    void submul(const BigInt &a, const BigInt &b);
+    BigInt value();
+    void clear();
+
+  private:
+    // An invalid base leaves base 0, which every operation rejects
+    int base = 0;
+    vector<long long> limbs;
+    long long bound = 0;
+    void accumulate(const BigInt &a, int sign);
+    void accumulateProduct(const BigInt &a, const BigInt &b, int sign);
+    void normalize();
+};
+
+class RNSInteger;
 
+/*
+//  A residue number system: a set of primes just below 2^31 whose
+//  product M bounds the values it can hold (|x| < M / 2). Holds the
+//  tables needed to convert between BigInt and residues.
+*/
+class RNSBasis {
+  public:
+    RNSBasis(int count, int setbase = 10, unsigned threads = 1);
+    int size() const;
+    const vector<uint32_t> & getPrimes() const;
+    RNSInteger toRNS(const BigInt &a) const;
+    BigInt toBigInt(const RNSInteger &a) const;
 
   private:
     int base;
-    bool isPositive;
-    vector<int> vec;
+    unsigned threads;
+    vector<uint32_t> primes;
+    vector<vector<uint32_t>> inverses;
+    BigInt modulus;
+    BigInt halfModulus;
+    friend class RNSInteger;
+};
+
+/*
+//  A value stored as its residues modulo each prime of an RNSBasis.
+//  Addition, subtraction and multiplication work on each residue
+//  independently, in plain loops over contiguous arrays, and are split
+//  across the basis' threads when there are enough residues.
+*/
+class RNSInteger {
+  public:
+    RNSInteger(const RNSBasis &b);
+    const RNSInteger & operator += (const RNSInteger &b);
+    const RNSInteger & operator -= (const RNSInteger &b);
+    const RNSInteger & operator *= (const RNSInteger &b);
+    const vector<uint32_t> & getResidues() const;
+
+  private:
+    const RNSBasis *basis;
+    vector<uint32_t> residues;
+    template <typename F>
+    void forEachRange(F f);
+    friend class RNSBasis;
+};
+
+/*
+//  Cancellation flag for asynchronous operations. Copies share one flag,
+//  so the caller keeps a copy and calls cancel() on it while the
+//  operation holds another.
+*/
+class CancellationToken {
+  public:
+    CancellationToken();
+    void cancel() const;
+    bool cancelled() const;
+
+  private:
+    shared_ptr<atomic<bool>> flag;
+};
+
+/*
+//  Thrown from the future's get() when an asynchronous operation was
+//  cancelled before it finished.
+*/
+class OperationCancelled : public runtime_error {
+  public:
+    OperationCancelled();
+};
+
+/*
+//  How an asynchronous operation runs.
+//    - token: checked at checkpoints inside the multiplication, division
+//      and exponentiation loops.
+//    - progress: called on the worker thread with the fraction done
+//      (0 to 1), at most about once per percent, and with 1 at the end.
+//    - executor: given the job to run; by default each operation runs on
+//      its own thread through std::async.
+*/
+struct AsyncOptions {
+    CancellationToken token;
+    function<void(double)> progress;
+    function<void(function<void()>)> executor;
+};
+
+/*
+//  Sizes (in digits) at which the algorithms switch tiers.
+//    - karatsubaMultiply, karatsubaSquare: operands at least this long
+//      use Karatsuba instead of schoolbook.
+//    - radixConversionLeaf: runs of at most this many digits are
+//      converted by Horner's rule in toBase.
+*/
+struct BigIntThresholds {
+    int karatsubaMultiply;
+    int karatsubaSquare;
+    int radixConversionLeaf;
+};
+
+/*
+//  Exact partial sums of a series by binary splitting (see binarySplit).
+//  For the terms first..last-1:
+//    P = p(first)...p(last-1),  Q = q(first)...q(last-1),
+//    B = b(first)...b(last-1),
+//    T = B * Q * sum over k of a(k) / b(k) * p(first)...p(k) / (q(first)...q(k)),
+//  so the sum is T / (B * Q). Without b, B is 1, and an empty range
+//  gives P = Q = B = 1, T = 0 in the given base.
+*/
+struct SeriesSplit {
+    BigInt P;
+    BigInt Q;
+    BigInt B;
+    BigInt T;
 };
 
   BigInt operator + (const  BigInt &a, const BigInt & b);
@@ -44,11 +417,66 @@ class BigInt {
   BigInt operator * (const  BigInt &a, const BigInt & b);
   BigInt operator / (const  BigInt &a, const BigInt & b);
   BigInt operator % (const  BigInt &a, const BigInt & b);
+  BigInt square(const BigInt &a);
   BigInt pow(const  BigInt &a, const BigInt & b);
   BigInt modPow(const BigInt &a, const BigInt &b, const BigInt &m);
+  BigInt product(span<const BigInt> values, unsigned threads = 1);
+  BigInt factorial(uint64_t n, int setbase = 10, unsigned threads = 1);
+  BigInt binomial(uint64_t n, uint64_t k, int setbase = 10, unsigned threads = 1);
+  BigInt primorial(uint64_t n, int setbase = 10, unsigned threads = 1);
+  BigInt isqrt(const BigInt &n);
+  BigInt nextPrime(const BigInt &n);
+  vector<bool> isProbablePrime(span<const BigInt> candidates, int rounds = 0, unsigned threads = 1);
+  future<BigInt> multiplyAsync(const BigInt &a, const BigInt &b, AsyncOptions options = AsyncOptions());
+  future<BigInt> powAsync(const BigInt &a, const BigInt &b, AsyncOptions options = AsyncOptions());
+  future<BigInt> modPowAsync(const BigInt &a, const BigInt &b, const BigInt &m, AsyncOptions options = AsyncOptions());
+  future<pair<BigInt, BigInt>> divisionAsync(const BigInt &a, const BigInt &b, AsyncOptions options = AsyncOptions());
+  BigIntThresholds getThresholds();
+  void setThresholds(const BigIntThresholds &thresholds);
+  bool loadThresholds(const string &path);
+  bool saveThresholds(const string &path);
+  BigIntThresholds tuneThresholds();
+  SeriesSplit binarySplit(uint64_t first, uint64_t last, const function<BigInt(uint64_t)> &p,
+                          const function<BigInt(uint64_t)> &q, const function<BigInt(uint64_t)> &a,
+                          const function<BigInt(uint64_t)> &b = nullptr, int setbase = 10,
+                          unsigned threads = 1);
+  BigInt piDigits(uint64_t digits, int setbase = 10, unsigned threads = 1);
+  BigInt eDigits(uint64_t digits, int setbase = 10, unsigned threads = 1);
+  RNSInteger operator + (const RNSInteger &a, const RNSInteger &b);
+  RNSInteger operator - (const RNSInteger &a, const RNSInteger &b);
+  RNSInteger operator * (const RNSInteger &a, const RNSInteger &b);
   bool operator == (const BigInt &a, const BigInt &b);
   bool operator != (const BigInt &a, const BigInt &b);
+  strong_ordering operator <=> (const BigInt &a, const BigInt &b);
   bool operator <= (const BigInt &a, const BigInt &b);
   bool operator >= (const BigInt &a, const BigInt &b);
   bool operator > (const BigInt &a, const BigInt &b);
   bool operator < (const BigInt &a, const BigInt &b);
+
+  template <typename T, typename enable_if<isMachineInteger<T>, int>::type = 0>
+  BigInt operator + (const BigInt &a, T b) { BigInt temp = a; return temp += b; }
+  template <typename T, typename enable_if<isMachineInteger<T>, int>::type = 0>
+  BigInt operator - (const BigInt &a, T b) { BigInt temp = a; return temp -= b; }
+  template <typename T, typename enable_if<isMachineInteger<T>, int>::type = 0>
+  BigInt operator * (const BigInt &a, T b) { BigInt temp = a; return temp *= b; }
+  template <typename T, typename enable_if<isMachineInteger<T>, int>::type = 0>
+  BigInt operator / (const BigInt &a, T b) { BigInt temp = a; return temp /= b; }
+  template <typename T, typename enable_if<isMachineInteger<T>, int>::type = 0>
+  BigInt operator % (const BigInt &a, T b) { BigInt temp = a; return temp %= b; }
+  template <typename T, typename enable_if<isMachineInteger<T>, int>::type = 0>
+  BigInt pow(const BigInt &a, T b) { BigInt temp = a; return temp.exponentiation(b); }
+  template <typename T, typename enable_if<isMachineInteger<T>, int>::type = 0>
+  BigInt modPow(const BigInt &a, T b, const BigInt &m) { BigInt temp = a; return temp.modulusExp(b, m); }
+
+  // Comparisons with a machine integer read its digits in a's base;
+  // the reversed forms and != < <= > >= are derived from these
+  template <typename T, typename enable_if<isMachineInteger<T>, int>::type = 0>
+  bool operator == (const BigInt &a, T b) { return a.compare(b) == 0; }
+  template <typename T, typename enable_if<isMachineInteger<T>, int>::type = 0>
+  strong_ordering operator <=> (const BigInt &a, T b) { return a.compare(b) <=> 0; }
+
+  // Lets BigInt be a key in unordered containers
+  template <>
+  struct std::hash<BigInt> {
+    size_t operator () (const BigInt &a) const { return a.hash(); }
+  };
@@ -46,6 +46,113 @@ int main (int argc, char* argv[]) {
 	cout << c.to_string() << endl;
 
 
+	// Machine Integer Operand Tests
+	cout << endl << "Machine Integer Operand Tests:" << endl;
+
+	BigInt fact(1, 10);
+	for (int i = 2; i <= 30; i++) {
+		fact *= i;
+	}
+	cout << "30! = " << fact.to_string() << endl;
+	cout << "30! / 1000000007 = " << (fact / 1000000007).to_string() << endl;
+	cout << "30! % 1000000007 = " << (fact % 1000000007).to_string() << endl;
+
+	__int128 wide = (__int128) 1 << 70;
+	BigInt wideSum(0, 10);
+	wideSum += wide;
+	cout << "0 + 2^70 = " << wideSum.to_string() << ", compare with 2^70: " << wideSum.compare(wide)
+	     << ", 2^70 < 2^70 + 1: " << (wideSum < wide + 1) << endl;
+
+
+	// Product Tree Tests
+	cout << endl << "Product Tree Tests:" << endl;
+
+	cout << "50! = " << factorial(50).to_string() << endl;
+	cout << "100 choose 50 = " << binomial(100, 50).to_string() << endl;
+	cout << "Primorial of 100 (base 16) = " << primorial(100, 16).to_string() << endl;
+
+
+	// Primality Tests
+	cout << endl << "Primality Tests:" << endl;
+
+	BigInt mersenne("170141183460469231731687303715884105727", 10);
+	BigInt pseudoprime("3825123056546413051", 10);
+	cout << mersenne.to_string() << " is prime: " << mersenne.isProbablePrime() << endl;
+	cout << pseudoprime.to_string() << " is prime: " << pseudoprime.isProbablePrime() << endl;
+	cout << "Next prime after 10^30: " << nextPrime(BigInt("1000000000000000000000000000000", 10)).to_string() << endl;
+
+
+
+	// Accumulator Tests
+	cout << endl << "Accumulator Tests:" << endl;
+
+	BigIntAccumulator dot(10);
+	for (int i = 1; i <= 100; i++) {
+		dot.addmul(BigInt(i, 10), fact);
+	}
+	dot.submul(BigInt(5050, 10), fact);
+	cout << "Sum of i * 30! minus 5050 * 30!: " << dot.value().to_string() << endl;
+
+
+	// Residue Number System Tests
+	cout << endl << "Residue Number System Tests:" << endl;
+
+	RNSBasis basis(8, 10);
+	RNSInteger x = basis.toRNS(fact);
+	RNSInteger y = basis.toRNS(lhs);
+	cout << "30! * 30! - 30! * -32 = " << basis.toBigInt(x * x - x * y).to_string() << endl;
+
+
+	// Mixed Base Tests
+	cout << endl << "Mixed Base Tests:" << endl;
+
+	BigInt hex("FF", 16);
+	BigInt dec(255, 10);
+	cout << "FF (base 16) in base 2: " << hex.toBase(2).to_string() << endl;
+	cout << "FF (base 16) + 255 (base 10) = " << (hex + dec).to_string() << " (base 16)" << endl;
+	cout << "FF (base 16) == 255 (base 10): " << (hex == dec) << endl;
+	BigInt thousand = factorial(1000, 10);
+	cout << "1000! in base 36 with 4 threads: " << thousand.toBase(36, 4).to_string(4).substr(0, 20) << "..." << endl;
+
+
+	// Machine Type Conversion Tests
+	cout << endl << "Machine Type Conversion Tests:" << endl;
+
+	BigInt huge(INT64_MIN, 16);
+	cout << "INT64_MIN in base 16: " << huge.to_string() << ", back: " << huge.to_int64() << endl;
+	cout << "1e300 as a BigInt has " << BigInt(1e300, 10).to_string().size() << " digits" << endl;
+	cout << "30! as a double: " << fact.to_double() << ", fits in int64_t: " << fact.fitsIn<int64_t>() << endl;
+
+
+	// Asynchronous Operation Tests
+	cout << endl << "Asynchronous Operation Tests:" << endl;
+
+	AsyncOptions options;
+	future<BigInt> power = powAsync(BigInt(2, 10), BigInt(1000, 10), options);
+	cout << "2^1000 computed asynchronously has " << power.get().to_string().size() << " digits" << endl;
+	options.token.cancel();
+	try {
+		modPowAsync(fact, BigInt(1000000, 10), lhs, options).get();
+	}
+	catch (const OperationCancelled &e) {
+		cout << "Cancelled modPow: " << e.what() << endl;
+	}
+
+
+
+	// Series Tests
+	cout << endl << "Series Tests:" << endl;
+
+	cout << "pi to 60 places: " << piDigits(60, 10).to_string() << endl;
+	cout << "e to 60 places: " << eDigits(60, 10).to_string() << endl;
+	cout << "pi in base 16: " << piDigits(30, 16, 2).to_string() << endl;
+
+	auto termOne = [](uint64_t) { return BigInt(1, 10); };
+	auto termTwo = [](uint64_t) { return BigInt(2, 10); };
+	SeriesSplit empty = binarySplit(5, 5, termOne, termTwo, termOne, nullptr, 10);
+	cout << "Empty series: P = " << empty.P.to_string() << ", Q = " << empty.Q.to_string()
+	     << ", T = " << empty.T.to_string() << endl;
+
 
 	return 0;
 }
@@ -0,0 +1,26 @@
+#include <iostream>
+#include <string>
+#include "bigint.h"
+
+using namespace std;
+
+//Measures the algorithm crossovers on this machine and saves them as a
+//tuning profile (bigint.tuning by default). BigInt loads it at startup
+//when BIGINT_TUNING names it, or a program can call loadThresholds
+
+int main (int argc, char* argv[]) {
+	string path = argc > 1 ? argv[1] : "bigint.tuning";
+
+	BigIntThresholds before = getThresholds();
+	BigIntThresholds tuned = tuneThresholds();
+	cout << "Karatsuba multiply threshold: " << before.karatsubaMultiply << " -> " << tuned.karatsubaMultiply << endl;
+	cout << "Karatsuba square threshold: " << before.karatsubaSquare << " -> " << tuned.karatsubaSquare << endl;
+	cout << "Radix conversion leaf: " << before.radixConversionLeaf << " -> " << tuned.radixConversionLeaf << endl;
+
+	if (!saveThresholds(path)) {
+		cout << "Could not write " << path << endl;
+		return 1;
+	}
+	cout << "Saved to " << path << " (load it with BIGINT_TUNING=" << path << " or loadThresholds)" << endl;
+	return 0;
+}